@@ -2,7 +2,9 @@
 #include "engine/DNNEngine.h"
 #include "engine/OrtEngine.h"
 #include <opencv2/imgproc.hpp>
-#include <android/log.h>
+#include "../utils/log.h"
+#include "../utils/arena.h"
+#include "../utils/profiler.h"
 
 using namespace cv;
 using namespace std;
@@ -11,36 +13,251 @@ std::unique_ptr<AIController> aiController;
 
 AIController::AIController() {}
 
+AIController::~AIController() {
+    {
+        lock_guard<mutex> lock(warmupMutex);
+        if (warmupThread.joinable()) warmupThread.join();
+    }
+    stopWorker();
+}
+
 bool AIController::init(const std::string& modelPath, const std::string& engineType) {
-    currentModelPath = modelPath;
-    setEngine(engineType);
-    return engine != nullptr && engine->loadModel(currentModelPath);
+    bool loaded;
+    {
+        lock_guard<mutex> lock(engineMutex);
+        if (modelPath != currentModelPath) {
+            // Pooled engines hold the old model
+            enginePool.clear();
+            engine.reset();
+            lock_guard<mutex> overlayLock(overlayMutex);
+            overlay.clear();
+        }
+        currentModelPath = modelPath;
+        // Loads exactly once, or reuses a pooled engine already holding this model
+        loaded = activateEngine(engineType);
+    }
+    if (loaded) startWarmup();
+    return loaded;
 }
 
 void AIController::setEngine(const std::string& engineType) {
-    __android_log_print(ANDROID_LOG_INFO, "AIController", "Switching engine to: %s", engineType.c_str());
+    LOGI("AIController", "Switching engine to: %s", engineType.c_str());
+    bool loaded;
+    {
+        lock_guard<mutex> lock(engineMutex);
+        if (engineType == currentEngineType && engine && engineLoaded) return;
+        loaded = activateEngine(engineType);
+    }
+    if (loaded) startWarmup();
+}
+
+std::string AIController::engineType() {
+    lock_guard<mutex> lock(engineMutex);
+    return currentEngineType;
+}
+
+vector<string> AIController::classNames() {
+    lock_guard<mutex> lock(engineMutex);
+    return engine ? engine->getClassNames() : vector<string>();
+}
+
+unique_ptr<Engine> AIController::createEngine(const std::string& engineType) {
     if (engineType == "ONNXRuntime") {
-        engine = make_unique<OrtEngine>();
+        // ORT providers are chosen at session creation, so configure before loading
+        auto ort = make_unique<OrtEngine>();
+        ort->setCacheDirectory(modelCacheDir);
+        ort->setSessionConfig(ortConfig);
+        ort->setBackend(currentBackend);
+        return ort;
+    }
+    return make_unique<DNNEngine>();
+}
+
+bool AIController::activateEngine(const std::string& engineType) {
+    auto start = chrono::steady_clock::now();
+    if (engine && engineLoaded) {
+        enginePool[currentEngineType] = std::move(engine);
+    }
+    engine.reset();
+    currentEngineType = engineType;
+    tracker.reset();
+    framesUntilDetection = 0;
+    lastResults.clear();
+    {
+        // Next frame must run the new engine (lock order: engineMutex, then gateMutex)
+        lock_guard<mutex> gateLock(gateMutex);
+        motionGate.reset();
+    }
+
+    auto pooled = enginePool.find(engineType);
+    const bool fromPool = pooled != enginePool.end();
+    if (fromPool) {
+        engine = std::move(pooled->second);
+        enginePool.erase(pooled);
+        engine->setBackend(currentBackend); // no-op unless the backend changed meanwhile
+        engineLoaded = true;
     } else {
-        engine = make_unique<DNNEngine>();
+        engine = createEngine(engineType);
+        engineLoaded = !currentModelPath.empty() && engine->loadModel(currentModelPath);
+        if (engineLoaded) engine->setBackend(currentBackend);
     }
-    
-    if (!currentModelPath.empty()) {
-        engine->loadModel(currentModelPath);
+    engine->setNmsConfig(nmsConfig);
+    updateInputSize(engine->inputSize());
+
+    loadStart = start;
+    awaitingFirstDetection = engineLoaded;
+    firstDetectionMs = -1.0f;
+    if (engineLoaded) {
+        LOGI("AIController", "%s ready in %.1f ms%s", engineType.c_str(),
+             chrono::duration<float, milli>(chrono::steady_clock::now() - start).count(),
+             fromPool ? " (pooled)" : "");
     }
+    return engineLoaded;
+}
+
+void AIController::startWarmup() {
+    if (!warmupEnabled) return;
+    // init and setEngine may race from different threads
+    lock_guard<mutex> warmupLock(warmupMutex);
+    if (warmupThread.joinable()) warmupThread.join();
+    warmupThread = thread([this] {
+        // Opportunistic: runs only while no frame wants the engine. A frame that
+        // gets there first pays the cold run itself instead of queueing behind
+        // the warm-up that was meant to hide it.
+        unique_lock<mutex> lock(engineMutex, try_to_lock);
+        if (!lock.owns_lock() || framesWaiting > 0) return;
+        if (!engine || !engineLoaded || !awaitingFirstDetection) return;
+        auto start = chrono::steady_clock::now();
+        Mat blank(engine->inputSize(), CV_8UC3, Scalar::all(114));
+        engine->detect(blank, 1.0f, 1.0f, {});
+        LOGI("AIController", "Warm-up inference: %.1f ms",
+             chrono::duration<float, milli>(chrono::steady_clock::now() - start).count());
+    });
+}
+
+void AIController::noteDetection() {
+    if (!awaitingFirstDetection) return;
+    awaitingFirstDetection = false;
+    firstDetectionMs = chrono::duration<float, milli>(chrono::steady_clock::now() - loadStart).count();
+    LOGI("AIController", "Time to first detection (%s): %.1f ms", currentEngineType.c_str(), firstDetectionMs.load());
+}
+
+void AIController::setWarmup(bool enabled) {
+    warmupEnabled = enabled;
+}
+
+unique_lock<mutex> AIController::lockEngineForFrame() {
+    ++framesWaiting;
+    unique_lock<mutex> lock(engineMutex);
+    --framesWaiting;
+    return lock;
+}
+
+float AIController::timeToFirstDetectionMs() const {
+    return firstDetectionMs;
+}
+
+void AIController::setModelCacheDir(const std::string& dir) {
+    lock_guard<mutex> lock(engineMutex);
+    modelCacheDir = dir;
+    if (auto* ort = dynamic_cast<OrtEngine*>(engine.get())) ort->setCacheDirectory(dir);
+    auto pooled = enginePool.find("ONNXRuntime");
+    if (pooled != enginePool.end()) static_cast<OrtEngine*>(pooled->second.get())->setCacheDirectory(dir);
 }
 
 void AIController::setBackend(const std::string& backend) {
+    lock_guard<mutex> lock(engineMutex);
+    currentBackend = backend;
     if (engine) {
         engine->setBackend(backend);
+        updateInputSize(engine->inputSize());
     }
 }
 
+void AIController::setOrtConfig(const OrtSessionConfig& config) {
+    lock_guard<mutex> lock(engineMutex);
+    ortConfig = config;
+    enginePool.erase("ONNXRuntime"); // would come back with stale settings
+    if (auto* ort = dynamic_cast<OrtEngine*>(engine.get())) {
+        OrtSessionConfig next = config;
+        next.provider = ort->sessionConfig().provider;
+        ort->setSessionConfig(next);
+        updateInputSize(ort->inputSize());
+    }
+}
+
+void AIController::setAsync(bool enabled) {
+    lock_guard<mutex> asyncLock(asyncMutex);
+    if (enabled == asyncEnabled) return;
+    if (enabled) {
+        {
+            // Drop a frame posted while the previous worker was shutting down
+            lock_guard<mutex> lock(mailboxMutex);
+            stopRequested = false;
+            mailboxFull = false;
+        }
+        worker = thread(&AIController::workerLoop, this);
+        asyncEnabled = true;
+    } else {
+        // Clear first: frames arriving during shutdown take the sync path
+        asyncEnabled = false;
+        stopWorker();
+    }
+    {
+        lock_guard<mutex> lock(engineMutex);
+        tracker.reset();
+        framesUntilDetection = 0;
+    }
+    LOGI("AIController", "Async inference %s", enabled ? "enabled" : "disabled");
+}
+
+void AIController::setDetectionInterval(int frames) {
+    lock_guard<mutex> lock(engineMutex);
+    detectionInterval = max(1, frames);
+    framesUntilDetection = 0;
+}
+
+void AIController::setTiling(const TilingConfig& config) {
+    lock_guard<mutex> lock(engineMutex);
+    tiler.setConfig(config);
+    tracker.reset();
+    framesUntilDetection = 0;
+    LOGI("AIController", "Tiled detection %s (overlap %.2f, max %d tiles, global view %d)",
+         config.enabled ? "on" : "off", config.overlap, config.maxTiles, config.globalView);
+}
+
+void AIController::setNmsConfig(const NmsConfig& config) {
+    lock_guard<mutex> lock(engineMutex);
+    nmsConfig = config;
+    if (engine) engine->setNmsConfig(config);
+}
+
+uint64_t AIController::resultFrameId() const {
+    return returnedFrameId;
+}
+
+uint64_t AIController::submittedFrameId() const {
+    return nextFrameId;
+}
+
 vector<YoloResult> AIController::processFrame(Mat& frame, float confThreshold, float iouThreshold, const vector<int>& allowedClasses) {
-    if (!engine) return {};
+    FrameScope scope;
+    Rect region;
+    const MotionDecision motion = gateColor(frame, region);
+
+    vector<YoloResult> results;
+    if (asyncEnabled.load()) {
+        // Static scene: nothing new for the worker, hand back what it last produced
+        results = motion == MotionDecision::Reuse ? latestAsyncResults()
+                                                  : submitAsync(frame, confThreshold, iouThreshold, allowedClasses);
+    } else {
+        auto lock = lockEngineForFrame();
+        if (!engine) return {};
 
-    // Detect
-    auto results = engine->detect(frame, confThreshold, iouThreshold, allowedClasses);
+        // Detect (or propagate tracks between keyframes)
+        results = detectOrTrack(frame, LetterboxTransform(), confThreshold, iouThreshold, allowedClasses, motion, region);
+        returnedFrameId = ++nextFrameId;
+    }
     
     // Draw (OpenCV composition)
     drawResults(frame, results);
@@ -48,23 +265,206 @@ vector<YoloResult> AIController::processFrame(Mat& frame, float confThreshold, f
     return results;
 }
 
-void AIController::drawResults(Mat& frame, const vector<YoloResult>& results) {
-    for (const auto& res : results) {
-        Scalar color(0, 255, 0, 255); // Green RGBA
-        
-        // Draw box
-        rectangle(frame, Rect(res.x, res.y, res.width, res.height), color, 2);
-        
-        // Draw label
-        string labelText = res.label + " " + to_string(int(res.confidence * 100)) + "%";
-        int baseLine;
-        Size labelSize = getTextSize(labelText, FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseLine);
-        int top = max(res.y, labelSize.height);
-        
-        rectangle(frame, Point(res.x, top - labelSize.height),
-                      Point(res.x + labelSize.width, top + baseLine), color, FILLED);
-        putText(frame, labelText, Point(res.x, top), FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0, 0, 0, 255), 1);
+vector<YoloResult> AIController::processYuv(const YuvPlanes& planes, float confThreshold, float iouThreshold, const vector<int>& allowedClasses) {
+    FrameScope scope;
+    // Gate on the Y plane in place, before any colour conversion happens
+    MotionDecision motion;
+    {
+        lock_guard<mutex> lock(gateMutex);
+        motion = motionGate.updateLuma(Mat(planes.height, planes.width, CV_8UC1, (void*)planes.y, planes.yRowStride));
+    }
+    // The detector sees the whole letterboxed frame here, so a region is a full run
+    if (motion == MotionDecision::Region) motion = MotionDecision::Run;
+    const bool async = asyncEnabled.load(); // one decision for the whole frame
+    if (async && motion == MotionDecision::Reuse) return latestAsyncResults();
+
+    // Convert only the downscaled planes, straight into the letterboxed detector input
+    LetterboxTransform letterbox = yuvToLetterbox(planes, workerInputSize(), staging);
+    if (async) {
+        return submitStaged(letterbox, confThreshold, iouThreshold, allowedClasses);
+    }
+
+    auto lock = lockEngineForFrame();
+    if (!engine) return {};
+    auto results = detectOrTrack(staging, letterbox, confThreshold, iouThreshold, allowedClasses, motion, Rect());
+    returnedFrameId = ++nextFrameId;
+    return results;
+}
+
+MotionDecision AIController::gateColor(const Mat& frame, Rect& region) {
+    lock_guard<mutex> lock(gateMutex);
+    MotionDecision motion = motionGate.updateColor(frame);
+    region = motionGate.changedRegion();
+    return motion;
+}
+
+void AIController::setMotionGate(const MotionGateConfig& config) {
+    lock_guard<mutex> lock(gateMutex);
+    motionGate.setConfig(config);
+    LOGI("AIController", "Motion gate %s (block %.1f, run above %.2f, stale after %d)",
+         config.enabled ? "on" : "off", config.blockThreshold, config.runFraction, config.maxStaleFrames);
+}
+
+float AIController::motionSkipRatio() {
+    lock_guard<mutex> lock(gateMutex);
+    return motionGate.skipRatio();
+}
+
+void AIController::setActiveClasses(const vector<int>& classIds) {
+    lock_guard<mutex> lock(classesMutex);
+    activeClasses = classIds;
+}
+
+vector<YoloResult> AIController::processFrame(Mat& frame, float confThreshold, float iouThreshold) {
+    lock_guard<mutex> lock(classesMutex);
+    return processFrame(frame, confThreshold, iouThreshold, activeClasses);
+}
+
+vector<YoloResult> AIController::processYuv(const YuvPlanes& planes, float confThreshold, float iouThreshold) {
+    lock_guard<mutex> lock(classesMutex);
+    return processYuv(planes, confThreshold, iouThreshold, activeClasses);
+}
+
+vector<YoloResult> AIController::detectOrTrack(const Mat& image, const LetterboxTransform& letterbox, float confThreshold, float iouThreshold, const vector<int>& allowedClasses,
+                                               MotionDecision motion, const Rect& region) {
+    // Unchanged scene: the previous boxes are still right, skip engine and tracker
+    if (motion == MotionDecision::Reuse) return lastResults;
+
+    bool keyframe = framesUntilDetection <= 0 || tracker.needsDetection();
+    if (!keyframe) {
+        framesUntilDetection--;
+        lastResults = tracker.predict();
+        return lastResults;
+    }
+
+    framesUntilDetection = detectionInterval - 1;
+    // Only a full-resolution source frame (identity letterbox) gains from tiling
+    // or region detection
+    const bool sourceFrame = letterbox.scale == 1.0f;
+    vector<YoloResult> results;
+    if (sourceFrame && motion == MotionDecision::Region && !region.empty()) {
+        results = detectRegion(image, region, confThreshold, iouThreshold, allowedClasses);
+    } else if (sourceFrame && tiler.shouldTile(image.size(), engine->inputSize())) {
+        results = tiler.detect(*engine, image, confThreshold, iouThreshold, allowedClasses);
+    } else {
+        results = engine->detect(image, confThreshold, iouThreshold, allowedClasses);
+        for (auto& res : results) letterbox.toSource(res);
     }
+    noteDetection();
+    tracker.update(results);
+    lastResults = results;
+    return results;
+}
+
+vector<YoloResult> AIController::detectRegion(const Mat& image, const Rect& region, float confThreshold, float iouThreshold, const vector<int>& allowedClasses) {
+    vector<YoloResult> results = engine->detect(image(region), confThreshold, iouThreshold, allowedClasses);
+    for (auto& res : results) {
+        res.x += region.x;
+        res.y += region.y;
+    }
+    // Boxes mostly outside the changed region still describe the scene
+    const Rect2f changed(region);
+    for (const auto& prev : lastResults) {
+        Rect2f box(prev.x, prev.y, prev.width, prev.height);
+        if ((box & changed).area() < 0.5f * box.area()) results.push_back(prev);
+    }
+    return results;
+}
+
+vector<YoloResult> AIController::submitAsync(const Mat& frame, float confThreshold, float iouThreshold, const vector<int>& allowedClasses) {
+    // Downscale on the caller's thread, overlapping with inference of the previous frame
+    LetterboxTransform letterbox = stager.toImage(frame, workerInputSize(), staging);
+    return submitStaged(letterbox, confThreshold, iouThreshold, allowedClasses);
+}
+
+vector<YoloResult> AIController::latestAsyncResults() {
+    lock_guard<mutex> lock(resultsMutex);
+    returnedFrameId = latestFrameId;
+    return latestResults;
+}
+
+vector<YoloResult> AIController::submitStaged(const LetterboxTransform& letterbox, float confThreshold, float iouThreshold, const vector<int>& allowedClasses) {
+    const uint64_t frameId = ++nextFrameId;
+    {
+        lock_guard<mutex> lock(mailboxMutex);
+        // Latest frame wins: an unconsumed frame is simply replaced. The swap hands
+        // its buffer back to staging, so no allocation happens in steady state.
+        swap(mailbox.image, staging);
+        mailbox.letterbox = letterbox;
+        mailbox.frameId = frameId;
+        mailbox.confThreshold = confThreshold;
+        mailbox.iouThreshold = iouThreshold;
+        mailbox.allowedClasses = allowedClasses;
+        mailboxFull = true;
+    }
+    mailboxCv.notify_one();
+    return latestAsyncResults();
+}
+
+Size AIController::workerInputSize() {
+    lock_guard<mutex> lock(mailboxMutex);
+    return engineInputSize;
+}
+
+void AIController::workerLoop() {
+    PendingFrame job;
+    while (true) {
+        {
+            unique_lock<mutex> lock(mailboxMutex);
+            mailboxCv.wait(lock, [this] { return mailboxFull || stopRequested; });
+            if (stopRequested) return;
+            swap(job.image, mailbox.image);
+            job.letterbox = mailbox.letterbox;
+            job.frameId = mailbox.frameId;
+            job.confThreshold = mailbox.confThreshold;
+            job.iouThreshold = mailbox.iouThreshold;
+            job.allowedClasses = mailbox.allowedClasses;
+            mailboxFull = false;
+        }
+
+        vector<YoloResult> results;
+        {
+            auto lock = lockEngineForFrame();
+            if (engine) {
+                results = engine->detect(job.image, job.confThreshold, job.iouThreshold, job.allowedClasses);
+                noteDetection();
+                for (auto& res : results) job.letterbox.toSource(res);
+                // Every async result is a keyframe; the tracker only assigns ids here
+                tracker.update(results);
+            }
+        }
+
+        lock_guard<mutex> lock(resultsMutex);
+        latestResults = std::move(results);
+        latestFrameId = job.frameId;
+    }
+}
+
+void AIController::updateInputSize(Size size) {
+    lock_guard<mutex> lock(mailboxMutex);
+    engineInputSize = size;
+}
+
+void AIController::stopWorker() {
+    {
+        lock_guard<mutex> lock(mailboxMutex);
+        stopRequested = true;
+        mailboxFull = false;
+    }
+    mailboxCv.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void AIController::setDrawOverlay(bool enabled) {
+    drawOverlay = enabled;
+    LOGI("AIController", "Overlay drawing %s", enabled ? "on" : "off");
+}
+
+void AIController::drawResults(Mat& frame, const vector<YoloResult>& results) {
+    if (!drawOverlay || results.empty()) return;
+    PROFILE_STAGE(Stage::Draw);
+    lock_guard<mutex> lock(overlayMutex);
+    overlay.draw(frame, results);
 }
 
 // Wrappers
@@ -72,9 +472,8 @@ bool initAI(const char* modelPath) {
     if (!aiController) {
         aiController = make_unique<AIController>();
     }
-    // Default to OpenCV initially if not specified, but init() requires engine type. 
-    // We'll default to OpenCV.
-    return aiController->init(modelPath, "OpenCV");
+    // Keep whichever engine was selected (OpenCV until setAIEngine says otherwise)
+    return aiController->init(modelPath, aiController->engineType());
 }
 
 void setAIEngine(const string& engineName) {
@@ -86,6 +485,93 @@ void setAIBackend(const string& backendName) {
     if (aiController) aiController->setBackend(backendName);
 }
 
+void setAIOrtConfig(const OrtSessionConfig& config) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setOrtConfig(config);
+}
+
+void setAIModelCacheDir(const string& dir) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setModelCacheDir(dir);
+}
+
+void setAIWarmup(bool enabled) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setWarmup(enabled);
+}
+
+float getAITimeToFirstDetectionMs() {
+    return aiController ? aiController->timeToFirstDetectionMs() : -1.0f;
+}
+
+void setAIAsync(bool enabled) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setAsync(enabled);
+}
+
+void setAIDetectionInterval(int frames) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setDetectionInterval(frames);
+}
+
+void setAINmsConfig(const NmsConfig& config) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setNmsConfig(config);
+}
+
+void setAIMotionGate(const MotionGateConfig& config) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setMotionGate(config);
+}
+
+float getAIMotionSkipRatio() {
+    return aiController ? aiController->motionSkipRatio() : 0.0f;
+}
+
+void setAIDrawOverlay(bool enabled) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setDrawOverlay(enabled);
+}
+
+void setAITiling(const TilingConfig& config) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setTiling(config);
+}
+
+vector<YoloResult> runAIInferenceYuv(const YuvPlanes& planes, float conf, float iou, const vector<int>& classes) {
+    if (aiController) {
+        return aiController->processYuv(planes, conf, iou, classes);
+    }
+    return {};
+}
+
+void setAIActiveClasses(const vector<int>& classes) {
+    if (!aiController) aiController = make_unique<AIController>();
+    aiController->setActiveClasses(classes);
+}
+
+vector<YoloResult> runAIInference(Mat& frame, float conf, float iou) {
+    if (aiController) {
+        return aiController->processFrame(frame, conf, iou);
+    }
+    return {};
+}
+
+vector<YoloResult> runAIInferenceYuv(const YuvPlanes& planes, float conf, float iou) {
+    if (aiController) {
+        return aiController->processYuv(planes, conf, iou);
+    }
+    return {};
+}
+
+vector<string> getAIClassNames() {
+    return aiController ? aiController->classNames() : vector<string>();
+}
+
+uint64_t getAIResultFrameId() {
+    return aiController ? aiController->resultFrameId() : 0;
+}
+
 vector<YoloResult> runAIInference(Mat& frame, float conf, float iou, const vector<int>& classes) {
     if (aiController) {
         return aiController->processFrame(frame, conf, iou, classes);
@@ -1,24 +1,178 @@
 #pragma once
 #include "engine/Engine.h"
+#include "engine/Letterbox.h"
+#include "engine/OrtEngine.h"
+#include "Tracker.h"
+#include "TiledDetector.h"
+#include "MotionGate.h"
+#include "OverlayRenderer.h"
+#include "../utils/yuv.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <opencv2/core.hpp>
 
 class AIController {
 public:
     AIController();
+    ~AIController();
     bool init(const std::string& modelPath, const std::string& engineType);
     void setEngine(const std::string& engineType);
+    std::string engineType();
+    // Class names of the active model (from its metadata or sidecar file)
+    std::vector<std::string> classNames();
     void setBackend(const std::string& backend);
-    
+    // Thread/spin/execution-mode settings for the ONNX Runtime engine; kept
+    // across engine switches. The provider comes from setBackend.
+    void setOrtConfig(const OrtSessionConfig& config);
+    // Where ORT keeps optimized graphs between runs (e.g. the app cache dir)
+    void setModelCacheDir(const std::string& dir);
+    // Run one throwaway inference in the background after each load so the
+    // first camera frame does not pay for lazy initialization. Skipped when a
+    // frame reaches the engine first.
+    void setWarmup(bool enabled);
+    // Milliseconds from the last model load / engine switch to its first
+    // detection result, -1 until that detection has happened.
+    float timeToFirstDetectionMs() const;
+
+    // Async mode: frames go to a dedicated inference worker through a
+    // single-slot, latest-frame-wins mailbox; processFrame returns the most
+    // recent completed results immediately instead of waiting for the model.
+    void setAsync(bool enabled);
+    // Frame id of the results returned by the last processFrame call, and
+    // id of the last frame submitted. Equal in sync mode.
+    uint64_t resultFrameId() const;
+    uint64_t submittedFrameId() const;
+
+    // Run the detector only every N frames (and whenever tracks decay);
+    // frames in between get Kalman-predicted boxes from the tracker.
+    void setDetectionInterval(int frames);
+
+    // Tiled detection for frames larger than the network input. Applies to
+    // synchronous processFrame; async and YUV paths already hand the worker a
+    // downscaled frame and keep single-view detection.
+    void setTiling(const TilingConfig& config);
+
+    // Skip the detector on static scenes: unchanged frames reuse the previous
+    // results, small changes are detected only in the changed region (sync
+    // RGBA path). The YUV path gates on the Y plane directly.
+    void setMotionGate(const MotionGateConfig& config);
+    // Fraction of frames since the last config change that reused results
+    float motionSkipRatio();
+
+    // Suppression settings, applied to the active engine and kept across switches
+    void setNmsConfig(const NmsConfig& config);
+
+    // Persistent class filter used by the overloads without allowedClasses;
+    // set only when the selection changes instead of copied in every frame.
+    void setActiveClasses(const std::vector<int>& classIds);
+
+    // Draw boxes and labels into the frame in processFrame; off when the UI
+    // renders its own overlay from the returned results
+    void setDrawOverlay(bool enabled);
+
     // Process frame: Detect and Draw
     std::vector<YoloResult> processFrame(cv::Mat& frame, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses);
+    // Detect straight from a YUV camera frame (no full-res RGBA); nothing is drawn.
+    // Boxes are in the unrotated sensor frame.
+    std::vector<YoloResult> processYuv(const YuvPlanes& planes, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses);
+    std::vector<YoloResult> processFrame(cv::Mat& frame, float confThreshold, float iouThreshold);
+    std::vector<YoloResult> processYuv(const YuvPlanes& planes, float confThreshold, float iouThreshold);
 
 private:
+    struct PendingFrame {
+        cv::Mat image; // letterboxed to the engine input size
+        LetterboxTransform letterbox;
+        uint64_t frameId = 0;
+        float confThreshold = 0;
+        float iouThreshold = 0;
+        std::vector<int> allowedClasses;
+    };
+
     std::unique_ptr<Engine> engine;
+    std::mutex engineMutex; // engine is shared with the inference worker
     std::string currentModelPath;
-    
+    std::string currentEngineType = "OpenCV";
+    bool engineLoaded = false;
+    // Loaded but inactive engines by type, so switching back is instant.
+    // Holds at most one engine per type; cleared when the model changes.
+    std::map<std::string, std::unique_ptr<Engine>> enginePool;
+    std::string modelCacheDir;
+
+    std::atomic<bool> warmupEnabled{true};
+    std::mutex warmupMutex; // guards warmupThread; never held while taking engineMutex
+    std::thread warmupThread;
+    // Frame paths waiting for engineMutex; a pending warm-up yields to them
+    std::atomic<int> framesWaiting{0};
+    std::chrono::steady_clock::time_point loadStart; // guarded by engineMutex
+    bool awaitingFirstDetection = false;
+    std::atomic<float> firstDetectionMs{-1.0f};
+    std::string currentBackend = "CPU";
+    OrtSessionConfig ortConfig;
+    NmsConfig nmsConfig;
+
+    // Tracking state, guarded by engineMutex
+    Tracker tracker;
+    int detectionInterval = 1;
+    int framesUntilDetection = 0;
+    TiledDetector tiler; // guarded by engineMutex
+    std::vector<YoloResult> lastResults; // last sync results, guarded by engineMutex
+
+    // Runs on the caller's thread before detection; never held while taking engineMutex
+    std::mutex gateMutex;
+    MotionGate motionGate;
+
+    std::mutex classesMutex; // held for a whole frame; setActiveClasses is rare
+    std::vector<int> activeClasses;
+
+    std::atomic<bool> drawOverlay{true};
+    std::mutex overlayMutex; // never held while taking engineMutex
+    OverlayRenderer overlay;
+
+    // Async pipeline state. asyncEnabled is read per frame without a lock;
+    // asyncMutex serializes setAsync, which owns starting and joining the worker.
+    std::atomic<bool> asyncEnabled{false};
+    std::mutex asyncMutex;
+    std::thread worker;
+    std::mutex mailboxMutex;
+    std::condition_variable mailboxCv;
+    PendingFrame mailbox;
+    bool mailboxFull = false;
+    bool stopRequested = false;
+    LetterboxPreprocessor stager; // caller-side preprocessing
+    cv::Mat staging;              // letterboxed engine input built on the caller's thread
+
+    cv::Size engineInputSize{640, 640}; // guarded by mailboxMutex
+
+    std::mutex resultsMutex;
+    std::vector<YoloResult> latestResults;
+    uint64_t latestFrameId = 0;
+    std::atomic<uint64_t> nextFrameId{0};
+    std::atomic<uint64_t> returnedFrameId{0};
+
+    std::unique_ptr<Engine> createEngine(const std::string& engineType);
+    bool activateEngine(const std::string& engineType);
+    void startWarmup();
+    std::unique_lock<std::mutex> lockEngineForFrame();
+    void noteDetection();
+    std::vector<YoloResult> submitAsync(const cv::Mat& frame, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses);
+    std::vector<YoloResult> submitStaged(const LetterboxTransform& letterbox, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses);
+    std::vector<YoloResult> detectOrTrack(const cv::Mat& image, const LetterboxTransform& letterbox, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses,
+                                          MotionDecision motion, const cv::Rect& region);
+    std::vector<YoloResult> detectRegion(const cv::Mat& image, const cv::Rect& region, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses);
+    MotionDecision gateColor(const cv::Mat& frame, cv::Rect& region);
+    std::vector<YoloResult> latestAsyncResults();
+    cv::Size workerInputSize();
+    void updateInputSize(cv::Size size);
+    void workerLoop();
+    void stopWorker();
     void drawResults(cv::Mat& frame, const std::vector<YoloResult>& results);
 };
 
@@ -29,4 +183,22 @@ extern std::unique_ptr<AIController> aiController;
 bool initAI(const char* modelPath);
 void setAIEngine(const std::string& engineName);
 void setAIBackend(const std::string& backendName);
+void setAIOrtConfig(const OrtSessionConfig& config);
+void setAIModelCacheDir(const std::string& dir);
+void setAIWarmup(bool enabled);
+float getAITimeToFirstDetectionMs();
+void setAIAsync(bool enabled);
+void setAIDetectionInterval(int frames);
+void setAITiling(const TilingConfig& config);
+void setAIMotionGate(const MotionGateConfig& config);
+float getAIMotionSkipRatio();
+void setAIDrawOverlay(bool enabled);
+void setAINmsConfig(const NmsConfig& config);
+uint64_t getAIResultFrameId();
+std::vector<std::string> getAIClassNames();
 std::vector<YoloResult> runAIInference(cv::Mat& frame, float conf, float iou, const std::vector<int>& classes);
+std::vector<YoloResult> runAIInferenceYuv(const YuvPlanes& planes, float conf, float iou, const std::vector<int>& classes);
+// Variants using the persistent class filter
+void setAIActiveClasses(const std::vector<int>& classes);
+std::vector<YoloResult> runAIInference(cv::Mat& frame, float conf, float iou);
+std::vector<YoloResult> runAIInferenceYuv(const YuvPlanes& planes, float conf, float iou);
@@ -0,0 +1,90 @@
+#include "MotionGate.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+Size thumbSize(Size source, int width) {
+    width = min(width, source.width);
+    return Size(width, max(1, (int)lround((double)source.height * width / source.width)));
+}
+
+} // namespace
+
+MotionGate::MotionGate(const MotionGateConfig& config) : config(config) {}
+
+void MotionGate::setConfig(const MotionGateConfig& newConfig) {
+    config = newConfig;
+    reset();
+}
+
+void MotionGate::reset() {
+    reference.release();
+    framesSinceRun = 0;
+    frames = 0;
+    reused = 0;
+}
+
+MotionDecision MotionGate::updateLuma(const Mat& luma) {
+    CV_Assert(luma.type() == CV_8UC1);
+    if (!config.enabled) return MotionDecision::Run;
+    // Area averaging doubles as denoising, so sensor noise does not read as motion
+    resize(luma, thumb, thumbSize(luma.size(), kThumbWidth), 0, 0, INTER_AREA);
+    return decide(luma.size());
+}
+
+MotionDecision MotionGate::updateColor(const Mat& frame) {
+    CV_Assert(frame.depth() == CV_8U && (frame.channels() == 3 || frame.channels() == 4));
+    if (!config.enabled) return MotionDecision::Run;
+    resize(frame, colorThumb, thumbSize(frame.size(), kThumbWidth), 0, 0, INTER_AREA);
+    cvtColor(colorThumb, thumb, frame.channels() == 4 ? COLOR_RGBA2GRAY : COLOR_RGB2GRAY);
+    return decide(frame.size());
+}
+
+MotionDecision MotionGate::decide(Size sourceSize) {
+    frames++;
+    const bool stale = ++framesSinceRun > config.maxStaleFrames;
+    if (reference.size() != thumb.size() || stale) {
+        thumb.copyTo(reference);
+        framesSinceRun = 0;
+        return MotionDecision::Run;
+    }
+
+    // Per-block mean absolute difference: area-resizing |diff| to the block grid
+    absdiff(thumb, reference, diff);
+    const Size grid((thumb.cols + kBlockSize - 1) / kBlockSize, (thumb.rows + kBlockSize - 1) / kBlockSize);
+    resize(diff, blockMeans, grid, 0, 0, INTER_AREA);
+
+    int changed = 0;
+    int minX = grid.width, minY = grid.height, maxX = -1, maxY = -1;
+    for (int by = 0; by < grid.height; ++by) {
+        const uchar* row = blockMeans.ptr<uchar>(by);
+        for (int bx = 0; bx < grid.width; ++bx) {
+            if (row[bx] < config.blockThreshold) continue;
+            changed++;
+            minX = min(minX, bx);
+            maxX = max(maxX, bx);
+            minY = min(minY, by);
+            maxY = max(maxY, by);
+        }
+    }
+
+    if (changed == 0) {
+        reused++;
+        return MotionDecision::Reuse;
+    }
+
+    thumb.copyTo(reference);
+    framesSinceRun = 0;
+    if (!config.regionDetection || changed > config.runFraction * grid.area()) return MotionDecision::Run;
+
+    // Changed blocks plus a one-block margin, scaled back to source pixels
+    const double sx = (double)sourceSize.width / grid.width, sy = (double)sourceSize.height / grid.height;
+    Rect blocks(Point(max(0, minX - 1), max(0, minY - 1)), Point(min(grid.width, maxX + 2), min(grid.height, maxY + 2)));
+    region = Rect(Point(cvFloor(blocks.x * sx), cvFloor(blocks.y * sy)),
+                  Point(cvCeil(blocks.br().x * sx), cvCeil(blocks.br().y * sy))) & Rect(Point(), sourceSize);
+    return MotionDecision::Region;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+struct MotionGateConfig {
+    bool enabled = false;
+    float blockThreshold = 10.0f; // mean |luma difference| (0-255) for a block to count as changed
+    float runFraction = 0.3f;     // changed area above this re-runs full detection
+    int maxStaleFrames = 30;      // full detection at least this often, whatever the scene does
+    bool regionDetection = true;  // small changes: detect only inside the changed region
+};
+
+enum class MotionDecision {
+    Run,    // detect on the whole frame
+    Reuse,  // scene unchanged, keep the previous results
+    Region, // detect only inside changedRegion()
+};
+
+// Cheap change detector in front of the detector: the frame's luma is
+// downsampled to a small thumbnail, compared against the thumbnail of the
+// last detected frame, and reduced to per-block mean absolute differences.
+class MotionGate {
+public:
+    explicit MotionGate(const MotionGateConfig& config = MotionGateConfig());
+
+    void setConfig(const MotionGateConfig& config);
+    const MotionGateConfig& getConfig() const { return config; }
+
+    // Full-resolution 8-bit luma, e.g. the camera's Y plane wrapped in place
+    MotionDecision updateLuma(const cv::Mat& luma);
+    // RGBA/RGB frame; only the downsampled thumbnail is converted to gray
+    MotionDecision updateColor(const cv::Mat& frame);
+
+    // Bounding box of the changed blocks in source pixels, valid after Region
+    cv::Rect changedRegion() const { return region; }
+
+    // Fraction of frames whose detection was skipped (Reuse)
+    float skipRatio() const { return frames ? (float)reused / frames : 0.0f; }
+    void reset();
+
+private:
+    MotionDecision decide(cv::Size sourceSize);
+
+    static constexpr int kThumbWidth = 160;
+    static constexpr int kBlockSize = 8; // in thumbnail pixels
+
+    MotionGateConfig config;
+    cv::Mat thumb;     // current downsampled luma
+    cv::Mat colorThumb;
+    cv::Mat reference; // thumbnail of the last frame the detector saw
+    cv::Mat diff;
+    cv::Mat blockMeans;
+    cv::Rect region;
+    int framesSinceRun = 0;
+    uint64_t frames = 0;
+    uint64_t reused = 0;
+};
@@ -0,0 +1,115 @@
+#include "OverlayRenderer.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstring>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+constexpr int kFont = FONT_HERSHEY_SIMPLEX;
+constexpr double kFontScale = 0.5;
+constexpr int kBoxThickness = 2;
+// Green box and label background, black text; identical in RGBA and BGR order
+const uchar kBoxColor[4] = {0, 255, 0, 255};
+const uchar kTextColor[4] = {0, 0, 0, 255};
+
+} // namespace
+
+OverlayRenderer::OverlayRenderer() {
+    Size size = getTextSize("0", kFont, kFontScale, 1, &baseline);
+    textHeight = size.height;
+    for (int a = 0; a < 256; ++a) {
+        for (int c = 0; c < 4; ++c) {
+            blend[a][c] = (uchar)((kBoxColor[c] * (255 - a) + kTextColor[c] * a + 127) / 255);
+        }
+    }
+}
+
+void OverlayRenderer::clear() {
+    names.clear();
+    for (auto& sprite : percents) sprite.release();
+}
+
+Mat OverlayRenderer::rasterize(const string& text) const {
+    int textBaseline = 0;
+    Size size = getTextSize(text, kFont, kFontScale, 1, &textBaseline);
+    Mat sprite(textHeight + baseline, max(size.width, 1), CV_8U, Scalar(0));
+    putText(sprite, text, Point(0, textHeight), kFont, kFontScale, Scalar(255), 1, LINE_AA);
+    return sprite;
+}
+
+const Mat& OverlayRenderer::nameSprite(const string& label) {
+    auto it = names.find(label);
+    if (it == names.end()) it = names.emplace(label, rasterize(label + " ")).first;
+    return it->second;
+}
+
+const Mat& OverlayRenderer::percentSprite(int percent) {
+    percent = min(max(percent, 0), 100);
+    Mat& sprite = percents[percent];
+    if (sprite.empty()) sprite = rasterize(to_string(percent) + "%");
+    return sprite;
+}
+
+void OverlayRenderer::draw(Mat& frame, const vector<YoloResult>& results) {
+    if (frame.empty() || frame.depth() != CV_8U || (frame.channels() != 3 && frame.channels() != 4)) return;
+
+    const int cn = frame.channels();
+    if (boxRowChannels != cn || (int)boxRow.size() < frame.cols * cn) {
+        boxRow.resize((size_t)frame.cols * cn);
+        for (int x = 0; x < frame.cols; ++x) memcpy(&boxRow[(size_t)x * cn], kBoxColor, cn);
+        boxRowChannels = cn;
+    }
+
+    for (const auto& res : results) {
+        Rect box(cvRound(res.x), cvRound(res.y), cvRound(res.width), cvRound(res.height));
+        drawBox(frame, box);
+        drawLabel(frame, box, nameSprite(res.label), percentSprite(int(res.confidence * 100)));
+    }
+}
+
+void OverlayRenderer::drawBox(Mat& frame, const Rect& box) {
+    const Rect clipped = box & Rect(0, 0, frame.cols, frame.rows);
+    if (clipped.empty()) return;
+    const int cn = frame.channels();
+    const size_t spanBytes = (size_t)clipped.width * cn;
+    const int t = kBoxThickness;
+
+    // Horizontal edges: whole spans copied from the prebuilt color row
+    for (int y = box.y; y < box.y + t; ++y) {
+        if (y >= clipped.y && y < clipped.y + clipped.height) memcpy(frame.ptr<uchar>(y, clipped.x), boxRow.data(), spanBytes);
+    }
+    for (int y = box.y + box.height - t; y < box.y + box.height; ++y) {
+        if (y >= clipped.y && y < clipped.y + clipped.height) memcpy(frame.ptr<uchar>(y, clipped.x), boxRow.data(), spanBytes);
+    }
+
+    // Vertical edges: a few pixels per row, only where the edge is on screen
+    const bool leftVisible = box.x >= 0;
+    const bool rightVisible = box.x + box.width <= frame.cols;
+    const int edge = min(t, clipped.width);
+    for (int y = clipped.y; y < clipped.y + clipped.height; ++y) {
+        if (leftVisible) memcpy(frame.ptr<uchar>(y, clipped.x), boxRow.data(), (size_t)edge * cn);
+        if (rightVisible) memcpy(frame.ptr<uchar>(y, clipped.x + clipped.width - edge), boxRow.data(), (size_t)edge * cn);
+    }
+}
+
+void OverlayRenderer::drawLabel(Mat& frame, const Rect& box, const Mat& name, const Mat& percent) {
+    // Same placement as the previous putText overlay: above the box, pushed
+    // inside the frame when the box touches the top edge
+    const int top = max(box.y, textHeight) - textHeight;
+    const int x = blit(frame, name, box.x, top);
+    blit(frame, percent, x, top);
+}
+
+int OverlayRenderer::blit(Mat& frame, const Mat& sprite, int x, int y) {
+    const Rect dst = Rect(x, y, sprite.cols, sprite.rows) & Rect(0, 0, frame.cols, frame.rows);
+    const int cn = frame.channels();
+    for (int row = dst.y; row < dst.y + dst.height; ++row) {
+        const uchar* alpha = sprite.ptr<uchar>(row - y) + (dst.x - x);
+        uchar* out = frame.ptr<uchar>(row, dst.x);
+        for (int i = 0; i < dst.width; ++i, out += cn) memcpy(out, blend[alpha[i]].data(), cn);
+    }
+    return x + sprite.cols;
+}
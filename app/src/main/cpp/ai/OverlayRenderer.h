@@ -0,0 +1,42 @@
+#pragma once
+#include "types.h"
+#include <opencv2/core.hpp>
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Draws detection boxes and labels onto RGBA/BGR frames without per-frame
+// text rasterization: each class name and each confidence percentage is
+// rendered once into an 8-bit coverage sprite, and a label is composed by
+// alpha-blitting its cached sprites. Box edges are written as whole pixel
+// rows, so cost grows with box perimeter rather than with font strokes.
+class OverlayRenderer {
+public:
+    OverlayRenderer();
+
+    // 8-bit 3- or 4-channel frames; anything else is left untouched
+    void draw(cv::Mat& frame, const std::vector<YoloResult>& results);
+    // Drop cached sprites, e.g. after the model (and its class names) changed
+    void clear();
+
+private:
+    // Alpha mask of one label fragment; text baseline sits at row textHeight
+    const cv::Mat& nameSprite(const std::string& label);
+    const cv::Mat& percentSprite(int percent);
+    cv::Mat rasterize(const std::string& text) const;
+
+    void drawBox(cv::Mat& frame, const cv::Rect& box);
+    void drawLabel(cv::Mat& frame, const cv::Rect& box, const cv::Mat& name, const cv::Mat& percent);
+    int blit(cv::Mat& frame, const cv::Mat& sprite, int x, int y);
+
+    int textHeight = 0;
+    int baseline = 0;
+    std::unordered_map<std::string, cv::Mat> names;
+    std::array<cv::Mat, 101> percents;
+
+    // Label pixel per coverage value: background blended towards the text color
+    std::array<std::array<uchar, 4>, 256> blend;
+    std::vector<uchar> boxRow; // box color repeated across a frame row
+    int boxRowChannels = 0;
+};
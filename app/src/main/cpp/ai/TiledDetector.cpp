@@ -0,0 +1,93 @@
+#include "TiledDetector.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+// Start offsets of `count` tiles of `tile` pixels spread evenly over `length`
+void tileStarts(int length, int tile, float overlap, vector<int>& starts) {
+    starts.clear();
+    if (length <= tile) {
+        starts.push_back(0);
+        return;
+    }
+    const float stride = tile * (1.0f - overlap);
+    const int count = (int)ceil((length - tile) / stride) + 1;
+    for (int i = 0; i < count; ++i) {
+        starts.push_back((int)lround((double)i * (length - tile) / (count - 1)));
+    }
+}
+
+int tileCount(int length, int tile, float overlap) {
+    if (length <= tile) return 1;
+    return (int)ceil((length - tile) / (tile * (1.0f - overlap))) + 1;
+}
+
+} // namespace
+
+TiledDetector::TiledDetector(const TilingConfig& config) : config(config) {}
+
+bool TiledDetector::shouldTile(Size frameSize, Size netSize) const {
+    return config.enabled && (frameSize.width > netSize.width || frameSize.height > netSize.height);
+}
+
+vector<Rect> TiledDetector::planTiles(Size frameSize, Size netSize) const {
+    const float overlap = min(max(config.overlap, 0.0f), 0.5f);
+    const int maxTiles = max(1, config.maxTiles);
+
+    // Native-resolution tiles first; grow them until the grid fits the budget
+    Size tile = netSize;
+    while (tileCount(frameSize.width, tile.width, overlap) * tileCount(frameSize.height, tile.height, overlap) > maxTiles) {
+        tile = Size((int)(tile.width * 1.25f), (int)(tile.height * 1.25f));
+    }
+
+    vector<int> xs, ys;
+    tileStarts(frameSize.width, tile.width, overlap, xs);
+    tileStarts(frameSize.height, tile.height, overlap, ys);
+    vector<Rect> rects;
+    for (int y : ys) {
+        for (int x : xs) {
+            rects.emplace_back(Rect(x, y, tile.width, tile.height) & Rect(Point(), frameSize));
+        }
+    }
+    return rects;
+}
+
+vector<YoloResult> TiledDetector::detect(Engine& engine, const Mat& frame, float confThreshold, float iouThreshold,
+                                         const vector<int>& allowedClasses) {
+    tiles = planTiles(frame.size(), engine.inputSize());
+    views.clear();
+    for (const Rect& tile : tiles) views.push_back(frame(tile));
+    if (config.globalView) views.push_back(frame);
+
+    auto perView = engine.detectBatch(views, confThreshold, iouThreshold, allowedClasses);
+
+    // Back to frame coordinates; the global view already is
+    merged.clear();
+    for (size_t i = 0; i < perView.size(); ++i) {
+        const Point offset = i < tiles.size() ? tiles[i].tl() : Point();
+        for (auto& res : perView[i]) {
+            res.x += offset.x;
+            res.y += offset.y;
+            merged.push_back(std::move(res));
+        }
+    }
+
+    // Cross-tile merge: per-class suppression by score. Besides IoU, a box mostly
+    // contained in a stronger one is dropped too, which removes the partial
+    // boxes an object leaves on the tile it only straddles.
+    candidates.clear();
+    for (const auto& res : merged) candidates.push(res.x, res.y, res.width, res.height, res.confidence, res.classId);
+    NmsConfig nmsConfig = engine.getNmsConfig();
+    nmsConfig.maxCandidates = 0; // already capped per view
+    nmsConfig.containmentThreshold = 0.7f;
+    nms.run(candidates, iouThreshold, nmsConfig, keep);
+
+    vector<YoloResult> results;
+    results.reserve(keep.size());
+    for (int idx : keep) results.push_back(std::move(merged[idx]));
+    return results;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "engine/Engine.h"
+#include "engine/Nms.h"
+#include <opencv2/core.hpp>
+#include <vector>
+
+struct TilingConfig {
+    bool enabled = false;
+    float overlap = 0.2f;   // fraction of a tile shared with its neighbour
+    int maxTiles = 12;      // tiles grow (and get downscaled) to stay within this
+    bool globalView = true; // also run the whole frame, for objects larger than a tile
+};
+
+// High-resolution detection: slices the frame into overlapping tiles of about
+// the network input size, runs them (plus an optional whole-frame view) as
+// one batched inference and merges the boxes across tile seams.
+class TiledDetector {
+public:
+    explicit TiledDetector(const TilingConfig& config = TilingConfig());
+
+    void setConfig(const TilingConfig& config) { this->config = config; }
+    const TilingConfig& getConfig() const { return config; }
+
+    // True when the frame is large enough for tiling to add detail
+    bool shouldTile(cv::Size frameSize, cv::Size netSize) const;
+
+    std::vector<YoloResult> detect(Engine& engine, const cv::Mat& frame, float confThreshold, float iouThreshold,
+                                   const std::vector<int>& allowedClasses);
+
+    // Tile rectangles covering frameSize, exposed for the benchmark
+    std::vector<cv::Rect> planTiles(cv::Size frameSize, cv::Size netSize) const;
+
+private:
+    TilingConfig config;
+    std::vector<cv::Rect> tiles;
+    std::vector<cv::Mat> views; // ROI headers into the frame, no pixel copies
+    std::vector<YoloResult> merged;
+    DetectionCandidates candidates;
+    Nms nms;
+    std::vector<int> keep;
+};
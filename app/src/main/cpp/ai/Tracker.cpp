@@ -0,0 +1,135 @@
+#include "Tracker.h"
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+// State: [cx, cy, w, h, vcx, vcy, vw, vh], measurement: [cx, cy, w, h]
+constexpr int kStateSize = 8;
+constexpr int kMeasureSize = 4;
+
+float iou(const Rect2f& a, const Rect2f& b) {
+    float inter = (a & b).area();
+    float uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+Rect2f resultBox(const YoloResult& r) {
+    return Rect2f(r.x, r.y, r.width, r.height);
+}
+
+void setResultBox(YoloResult& r, const Rect2f& box) {
+    r.x = box.x;
+    r.y = box.y;
+    r.width = box.width;
+    r.height = box.height;
+}
+
+} // namespace
+
+Tracker::Tracker(const TrackerConfig& config) : config(config), measurement(kMeasureSize, 1, CV_32F) {}
+
+Rect2f Tracker::stateBox(const Mat& state) {
+    float cx = state.at<float>(0), cy = state.at<float>(1);
+    float w = max(1.0f, state.at<float>(2)), h = max(1.0f, state.at<float>(3));
+    return Rect2f(cx - 0.5f * w, cy - 0.5f * h, w, h);
+}
+
+void Tracker::initTrack(Track& track, const YoloResult& det) {
+    track.kf.init(kStateSize, kMeasureSize, 0, CV_32F);
+    setIdentity(track.kf.transitionMatrix);
+    for (int i = 0; i < kMeasureSize; ++i) track.kf.transitionMatrix.at<float>(i, i + kMeasureSize) = 1.0f;
+    setIdentity(track.kf.measurementMatrix);
+    setIdentity(track.kf.processNoiseCov, Scalar::all(1e-2));
+    setIdentity(track.kf.measurementNoiseCov, Scalar::all(1e-1));
+    setIdentity(track.kf.errorCovPost, Scalar::all(1.0));
+
+    Mat& s = track.kf.statePost;
+    s.setTo(Scalar::all(0));
+    s.at<float>(0) = det.x + 0.5f * det.width;
+    s.at<float>(1) = det.y + 0.5f * det.height;
+    s.at<float>(2) = det.width;
+    s.at<float>(3) = det.height;
+
+    track.result = det;
+    track.missedKeyframes = 0;
+}
+
+void Tracker::update(vector<YoloResult>& detections) {
+    for (auto& track : tracks) track.kf.predict();
+
+    // Greedy association: best IoU pairs first, same class only
+    candidates.clear();
+    for (int t = 0; t < (int)tracks.size(); ++t) {
+        Rect2f predicted = stateBox(tracks[t].kf.statePre);
+        for (int d = 0; d < (int)detections.size(); ++d) {
+            if (detections[d].classId != tracks[t].result.classId) continue;
+            float overlap = iou(predicted, resultBox(detections[d]));
+            if (overlap >= config.matchIou) candidates.push_back({overlap, t, d});
+        }
+    }
+    sort(candidates.begin(), candidates.end(), [](const Match& a, const Match& b) { return a.iou > b.iou; });
+
+    trackMatched.assign(tracks.size(), 0);
+    detectionMatched.assign(detections.size(), 0);
+    for (const auto& m : candidates) {
+        if (trackMatched[m.track] || detectionMatched[m.detection]) continue;
+        trackMatched[m.track] = 1;
+        detectionMatched[m.detection] = 1;
+
+        Track& track = tracks[m.track];
+        YoloResult& det = detections[m.detection];
+        measurement.at<float>(0) = det.x + 0.5f * det.width;
+        measurement.at<float>(1) = det.y + 0.5f * det.height;
+        measurement.at<float>(2) = det.width;
+        measurement.at<float>(3) = det.height;
+        track.kf.correct(measurement);
+
+        det.trackId = track.id;
+        track.result = det;
+        track.missedKeyframes = 0;
+    }
+
+    // Age out unmatched tracks (reverse order keeps trackMatched indices valid)
+    for (int t = (int)tracks.size() - 1; t >= 0; --t) {
+        if (trackMatched[t]) continue;
+        if (++tracks[t].missedKeyframes > config.maxMissedKeyframes) tracks.erase(tracks.begin() + t);
+    }
+
+    for (int d = 0; d < (int)detections.size(); ++d) {
+        if (detectionMatched[d]) continue;
+        detections[d].trackId = nextId;
+        tracks.emplace_back();
+        tracks.back().id = nextId++;
+        initTrack(tracks.back(), detections[d]);
+    }
+}
+
+vector<YoloResult> Tracker::predict() {
+    vector<YoloResult> results;
+    results.reserve(tracks.size());
+    for (auto& track : tracks) {
+        const Mat& state = track.kf.predict();
+        // Propagate the prediction as the new posterior so the next frame keeps moving
+        state.copyTo(track.kf.statePost);
+        track.kf.errorCovPre.copyTo(track.kf.errorCovPost);
+
+        setResultBox(track.result, stateBox(state));
+        track.result.confidence *= config.confidenceDecay;
+        if (track.missedKeyframes == 0) results.push_back(track.result);
+    }
+    return results;
+}
+
+bool Tracker::needsDetection() const {
+    for (const auto& track : tracks) {
+        if (track.missedKeyframes == 0 && track.result.confidence < config.redetectConfidence) return true;
+    }
+    return false;
+}
+
+void Tracker::reset() {
+    tracks.clear();
+}
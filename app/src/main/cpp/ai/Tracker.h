@@ -0,0 +1,55 @@
+#pragma once
+#include "types.h"
+#include <opencv2/core.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <vector>
+
+struct TrackerConfig {
+    float matchIou = 0.3f;           // minimum IoU to associate a detection with a track
+    int maxMissedKeyframes = 2;      // keyframes a track may go unmatched before it is dropped
+    float confidenceDecay = 0.92f;   // per predicted frame
+    float redetectConfidence = 0.3f; // request a keyframe when a track decays below this
+};
+
+// SORT-style multi-object tracker: constant-velocity Kalman filter per track,
+// greedy per-class IoU association and stable track ids. Between detector
+// keyframes it propagates boxes by prediction alone.
+class Tracker {
+public:
+    explicit Tracker(const TrackerConfig& config = TrackerConfig());
+
+    // Keyframe: advances all tracks one frame, associates the fresh detections
+    // and writes their track ids.
+    void update(std::vector<YoloResult>& detections);
+    // In-between frame: advances all tracks one frame and returns predicted boxes.
+    std::vector<YoloResult> predict();
+    // True when a live track's confidence has decayed enough to want the detector.
+    bool needsDetection() const;
+    void reset();
+
+private:
+    struct Track {
+        int id;
+        cv::KalmanFilter kf;
+        YoloResult result;
+        int missedKeyframes = 0;
+    };
+
+    void initTrack(Track& track, const YoloResult& det);
+    static cv::Rect2f stateBox(const cv::Mat& state);
+
+    TrackerConfig config;
+    std::vector<Track> tracks;
+    int nextId = 1;
+
+    // Association scratch, reused across frames
+    struct Match {
+        float iou;
+        int track;
+        int detection;
+    };
+    std::vector<Match> candidates;
+    std::vector<uint8_t> trackMatched;
+    std::vector<uint8_t> detectionMatched;
+    cv::Mat measurement;
+};
@@ -1,5 +1,7 @@
 #pragma once
 #include "Engine.h"
+#include "Letterbox.h"
+#include "YoloDecoder.h"
 #include <opencv2/dnn.hpp>
 
 class DNNEngine : public Engine {
@@ -8,10 +10,22 @@ public:
     bool loadModel(const std::string& modelPath) override;
     void setBackend(const std::string& backend) override;
     std::vector<YoloResult> detect(const cv::Mat& input, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses) override;
+    std::vector<std::vector<YoloResult>> detectBatch(const std::vector<cv::Mat>& images, float confThreshold,
+                                                     float iouThreshold, const std::vector<int>& allowedClasses) override;
+    cv::Size inputSize() const override { return cv::Size(netInputWidth, netInputHeight); }
 
 private:
     cv::dnn::Net net;
     bool isLoaded = false;
+    bool batchUnsupported = false; // model graph pinned to batch 1
     const int netInputWidth = 640;
     const int netInputHeight = 640;
+
+    // Preprocessing scratch and NCHW input blob, reused across frames
+    LetterboxPreprocessor preprocessor;
+    cv::Mat blob;
+    std::vector<LetterboxTransform> letterboxes;
+    std::vector<std::string> outputLayerNames;
+    std::vector<cv::Mat> outputs;
+    YoloDecoder decoder;
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include "../types.h"
+#include "Nms.h"
 #include <opencv2/core.hpp>
 #include <vector>
 #include <string>
@@ -10,16 +11,24 @@ public:
     virtual bool loadModel(const std::string& modelPath) = 0;
     virtual std::vector<YoloResult> detect(const cv::Mat& input, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses) = 0;
     virtual void setBackend(const std::string& backend) = 0;
+    // Detects on several images in one inference where the engine can batch.
+    // Results are per image, in that image's coordinates.
+    virtual std::vector<std::vector<YoloResult>> detectBatch(const std::vector<cv::Mat>& images, float confThreshold,
+                                                             float iouThreshold, const std::vector<int>& allowedClasses) {
+        std::vector<std::vector<YoloResult>> results;
+        results.reserve(images.size());
+        for (const auto& image : images) results.push_back(detect(image, confThreshold, iouThreshold, allowedClasses));
+        return results;
+    }
+    // Network input resolution; frames are letterboxed to this size
+    virtual cv::Size inputSize() const { return cv::Size(640, 640); }
+    // Post-processing: per-class vs agnostic suppression, top-K and max detections
+    void setNmsConfig(const NmsConfig& config) { nmsConfig = config; }
+    const NmsConfig& getNmsConfig() const { return nmsConfig; }
+    // Class names of the loaded model, indexed by class id
+    const std::vector<std::string>& getClassNames() const { return classNames; }
 protected:
-    std::vector<std::string> classNames = {
-        "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat", "traffic light",
-        "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat", "dog", "horse", "sheep", "cow",
-        "elephant", "bear", "zebra", "giraffe", "backpack", "umbrella", "handbag", "tie", "suitcase", "frisbee",
-        "skis", "snowboard", "sports ball", "kite", "baseball bat", "baseball glove", "skateboard", "surfboard",
-        "tennis racket", "bottle", "wine glass", "cup", "fork", "knife", "spoon", "bowl", "banana", "apple",
-        "sandwich", "orange", "broccoli", "carrot", "hot dog", "pizza", "donut", "cake", "chair", "couch",
-        "potted plant", "bed", "dining table", "toilet", "tv", "laptop", "mouse", "remote", "keyboard", "cell phone",
-        "microwave", "oven", "toaster", "sink", "refrigerator", "book", "clock", "vase", "scissors", "teddy bear",
-        "hair drier", "toothbrush"
-    };
+    NmsConfig nmsConfig;
+    // Filled by loadModel from the model's metadata (see ModelMetadata.h)
+    std::vector<std::string> classNames;
 };
@@ -0,0 +1,250 @@
+#include "Letterbox.h"
+#include "../../utils/profiler.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+
+namespace {
+
+constexpr float kNorm = 1.0f / 255.0f;
+
+#if CV_SIMD128
+inline void storeNormalized(const v_uint8x16& v, float* dst, const v_float32x4& scale) {
+    v_uint16x8 lo, hi;
+    v_expand(v, lo, hi);
+    v_uint32x4 q0, q1, q2, q3;
+    v_expand(lo, q0, q1);
+    v_expand(hi, q2, q3);
+    v_store(dst, v_cvt_f32(v_reinterpret_as_s32(q0)) * scale);
+    v_store(dst + 4, v_cvt_f32(v_reinterpret_as_s32(q1)) * scale);
+    v_store(dst + 8, v_cvt_f32(v_reinterpret_as_s32(q2)) * scale);
+    v_store(dst + 12, v_cvt_f32(v_reinterpret_as_s32(q3)) * scale);
+}
+#endif
+
+// Deinterleaves one row of RGBA/RGB pixels into three normalized float planes.
+void interleavedRowToPlanar(const uchar* src, int cn, int width, float* r, float* g, float* b) {
+    int x = 0;
+#if CV_SIMD128
+    const v_float32x4 scale = v_setall_f32(kNorm);
+    for (; x <= width - 16; x += 16) {
+        v_uint8x16 c0, c1, c2, c3;
+        if (cn == 4) v_load_deinterleave(src + x * 4, c0, c1, c2, c3);
+        else v_load_deinterleave(src + x * 3, c0, c1, c2);
+        storeNormalized(c0, r + x, scale);
+        storeNormalized(c1, g + x, scale);
+        storeNormalized(c2, b + x, scale);
+    }
+#endif
+    for (; x < width; ++x) {
+        const uchar* px = src + x * cn;
+        r[x] = px[0] * kNorm;
+        g[x] = px[1] * kNorm;
+        b[x] = px[2] * kNorm;
+    }
+}
+
+// Writes one network-width row of each plane: left pad, pixels, right pad.
+void writeTensorRow(const uchar* src, int cn, const Rect& inner, int netWidth, float padValue,
+                    float* r, float* g, float* b) {
+    float* planes[3] = {r, g, b};
+    for (float* p : planes) {
+        std::fill(p, p + inner.x, padValue);
+        std::fill(p + inner.x + inner.width, p + netWidth, padValue);
+    }
+    interleavedRowToPlanar(src, cn, inner.width, r + inner.x, g + inner.x, b + inner.x);
+}
+
+// Deinterleaves one row of RGBA/RGB pixels into three 8-bit planes, mapping
+// each value through the quantization table (or its SIMD-friendly special cases).
+void interleavedRowToPlanarU8(const uchar* src, int cn, int width, uchar* r, uchar* g, uchar* b,
+                              const uint8_t* table, bool identity, bool flipSign) {
+    int x = 0;
+#if CV_SIMD128
+    if (identity || flipSign) {
+        const v_uint8x16 signBit = v_setall_u8(flipSign ? 0x80 : 0);
+        for (; x <= width - 16; x += 16) {
+            v_uint8x16 c0, c1, c2, c3;
+            if (cn == 4) v_load_deinterleave(src + x * 4, c0, c1, c2, c3);
+            else v_load_deinterleave(src + x * 3, c0, c1, c2);
+            v_store(r + x, c0 ^ signBit);
+            v_store(g + x, c1 ^ signBit);
+            v_store(b + x, c2 ^ signBit);
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        const uchar* px = src + x * cn;
+        r[x] = table[px[0]];
+        g[x] = table[px[1]];
+        b[x] = table[px[2]];
+    }
+}
+
+uint16_t toHalf(float v) {
+    uint16_t h;
+    Mat half(1, 1, CV_16F, &h);
+    Mat(1, 1, CV_32F, &v).convertTo(half, CV_16F);
+    return h;
+}
+
+Size innerSize(Size srcSize, Size netSize, float scale) {
+    return Size(std::min(netSize.width, (int)std::lround(srcSize.width * scale)),
+                std::min(netSize.height, (int)std::lround(srcSize.height * scale)));
+}
+
+} // namespace
+
+LetterboxTransform computeLetterbox(Size srcSize, Size netSize) {
+    LetterboxTransform t;
+    t.scale = std::min((float)netSize.width / srcSize.width, (float)netSize.height / srcSize.height);
+    Size inner = innerSize(srcSize, netSize, t.scale);
+    t.padX = (float)((netSize.width - inner.width) / 2);
+    t.padY = (float)((netSize.height - inner.height) / 2);
+    return t;
+}
+
+void LetterboxTransform::toSource(YoloResult& res) const {
+    res.x = toSourceX(res.x);
+    res.y = toSourceY(res.y);
+    res.width = toSourceLength(res.width);
+    res.height = toSourceLength(res.height);
+}
+
+Rect letterboxRect(Size srcSize, Size netSize, const LetterboxTransform& t) {
+    return Rect(Point((int)t.padX, (int)t.padY), innerSize(srcSize, netSize, t.scale));
+}
+
+const Mat& LetterboxPreprocessor::resizeInner(const Mat& src, Size netSize, LetterboxTransform& t, Rect& inner) {
+    t = computeLetterbox(src.size(), netSize);
+    inner = letterboxRect(src.size(), netSize, t);
+    if (inner.size() == src.size()) return src;
+    // 8-bit, channel-interleaved resize: cheap compared to resizing float data
+    resize(src, resized, inner.size(), 0, 0, INTER_LINEAR);
+    return resized;
+}
+
+LetterboxTransform LetterboxPreprocessor::toFloat32(const Mat& src, Size netSize, float* dst) {
+    PROFILE_STAGE(Stage::Preprocess);
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 3 || src.channels() == 4));
+    LetterboxTransform t;
+    Rect inner;
+    const Mat& img = resizeInner(src, netSize, t, inner);
+
+    const size_t planeSize = (size_t)netSize.area();
+    float* r = dst;
+    float* g = dst + planeSize;
+    float* b = dst + 2 * planeSize;
+    const float padValue = kPadValue * kNorm;
+
+    for (int y = 0; y < netSize.height; ++y) {
+        size_t offset = (size_t)y * netSize.width;
+        if (y < inner.y || y >= inner.y + inner.height) {
+            std::fill(r + offset, r + offset + netSize.width, padValue);
+            std::fill(g + offset, g + offset + netSize.width, padValue);
+            std::fill(b + offset, b + offset + netSize.width, padValue);
+            continue;
+        }
+        writeTensorRow(img.ptr<uchar>(y - inner.y), img.channels(), inner, netSize.width, padValue,
+                       r + offset, g + offset, b + offset);
+    }
+    return t;
+}
+
+LetterboxTransform LetterboxPreprocessor::toFloat16(const Mat& src, Size netSize, uint16_t* dst) {
+    PROFILE_STAGE(Stage::Preprocess);
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 3 || src.channels() == 4));
+    LetterboxTransform t;
+    Rect inner;
+    const Mat& img = resizeInner(src, netSize, t, inner);
+
+    rowScratch.create(3, netSize.width, CV_32F);
+    const size_t planeSize = (size_t)netSize.area();
+    const float padValue = kPadValue * kNorm;
+    const uint16_t padHalf = toHalf(padValue);
+
+    for (int y = 0; y < netSize.height; ++y) {
+        size_t offset = (size_t)y * netSize.width;
+        if (y < inner.y || y >= inner.y + inner.height) {
+            for (int c = 0; c < 3; ++c) {
+                std::fill(dst + c * planeSize + offset, dst + c * planeSize + offset + netSize.width, padHalf);
+            }
+            continue;
+        }
+        writeTensorRow(img.ptr<uchar>(y - inner.y), img.channels(), inner, netSize.width, padValue,
+                       rowScratch.ptr<float>(0), rowScratch.ptr<float>(1), rowScratch.ptr<float>(2));
+        // OpenCV's vectorized fp32 -> fp16 conversion, written in place into the tensor
+        for (int c = 0; c < 3; ++c) {
+            Mat halfRow(1, netSize.width, CV_16F, dst + c * planeSize + offset);
+            rowScratch.row(c).convertTo(halfRow, CV_16F);
+        }
+    }
+    return t;
+}
+
+void LetterboxPreprocessor::updateQuantTable(float scale, int zeroPoint, bool isSigned) {
+    if (scale == quantScale && zeroPoint == quantZeroPoint && isSigned == quantSigned) return;
+    quantScale = scale;
+    quantZeroPoint = zeroPoint;
+    quantSigned = isSigned;
+
+    bool identity = true, flipSign = true;
+    const int lo = isSigned ? -128 : 0, hi = isSigned ? 127 : 255;
+    for (int p = 0; p < 256; ++p) {
+        int q = (int)std::lround(p * kNorm / scale) + zeroPoint;
+        quantTable[p] = (uint8_t)std::min(hi, std::max(lo, q));
+        identity &= quantTable[p] == p;
+        flipSign &= quantTable[p] == (p ^ 0x80);
+    }
+    quantMapping = identity ? QuantMapping::Identity : flipSign ? QuantMapping::FlipSign : QuantMapping::Table;
+}
+
+LetterboxTransform LetterboxPreprocessor::toQuantized(const Mat& src, Size netSize, uint8_t* dst,
+                                                      float scale, int zeroPoint, bool isSigned) {
+    PROFILE_STAGE(Stage::Preprocess);
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 3 || src.channels() == 4) && scale > 0);
+    LetterboxTransform t;
+    Rect inner;
+    const Mat& img = resizeInner(src, netSize, t, inner);
+    updateQuantTable(scale, zeroPoint, isSigned);
+
+    const size_t planeSize = (size_t)netSize.area();
+    const uint8_t padValue = quantTable[kPadValue];
+    const bool identity = quantMapping == QuantMapping::Identity;
+    const bool flipSign = quantMapping == QuantMapping::FlipSign;
+
+    for (int y = 0; y < netSize.height; ++y) {
+        size_t offset = (size_t)y * netSize.width;
+        uint8_t* planes[3] = {dst + offset, dst + planeSize + offset, dst + 2 * planeSize + offset};
+        if (y < inner.y || y >= inner.y + inner.height) {
+            for (uint8_t* p : planes) std::fill(p, p + netSize.width, padValue);
+            continue;
+        }
+        for (uint8_t* p : planes) {
+            std::fill(p, p + inner.x, padValue);
+            std::fill(p + inner.x + inner.width, p + netSize.width, padValue);
+        }
+        interleavedRowToPlanarU8(img.ptr<uchar>(y - inner.y), img.channels(), inner.width,
+                                 planes[0] + inner.x, planes[1] + inner.x, planes[2] + inner.x,
+                                 quantTable, identity, flipSign);
+    }
+    return t;
+}
+
+LetterboxTransform LetterboxPreprocessor::toImage(const Mat& src, Size netSize, Mat& dst) {
+    PROFILE_STAGE(Stage::Preprocess);
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 3 || src.channels() == 4));
+    LetterboxTransform t;
+    Rect inner;
+    const Mat& img = resizeInner(src, netSize, t, inner);
+
+    dst.create(netSize, CV_8UC3);
+    dst.setTo(Scalar::all(kPadValue));
+    Mat roi = dst(inner);
+    if (img.channels() == 4) cvtColor(img, roi, COLOR_RGBA2RGB);
+    else img.copyTo(roi);
+    return t;
+}
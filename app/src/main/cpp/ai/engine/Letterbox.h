@@ -0,0 +1,62 @@
+#pragma once
+#include "../types.h"
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+// Aspect-preserving resize + pad that maps a source frame into the network
+// input. Box coordinates predicted in network space are mapped back with
+// the inverse transform.
+struct LetterboxTransform {
+    float scale = 1.0f; // source pixels -> network pixels
+    float padX = 0.0f;
+    float padY = 0.0f;
+
+    float toSourceX(float x) const { return (x - padX) / scale; }
+    float toSourceY(float y) const { return (y - padY) / scale; }
+    float toSourceLength(float len) const { return len / scale; }
+
+    // Maps a detection made on the letterboxed image back to the source frame
+    void toSource(YoloResult& res) const;
+};
+
+LetterboxTransform computeLetterbox(cv::Size srcSize, cv::Size netSize);
+// Region of the network input covered by the resized source image
+cv::Rect letterboxRect(cv::Size srcSize, cv::Size netSize, const LetterboxTransform& t);
+
+// Fused preprocessing: RGBA/RGB 8-bit frame -> letterboxed, normalized
+// (x / 255) planar NCHW tensor written straight into a caller-owned buffer
+// of 3 * netSize.area() elements. Keeps its resize scratch between frames.
+class LetterboxPreprocessor {
+public:
+    LetterboxTransform toFloat32(const cv::Mat& src, cv::Size netSize, float* dst);
+    LetterboxTransform toFloat16(const cv::Mat& src, cv::Size netSize, uint16_t* dst);
+    // Quantized uint8/int8 tensor (int8 stored as its bit pattern):
+    // q = saturate(round(pixel / 255 / scale) + zeroPoint). The usual exports
+    // (scale 1/255, zero point 0 or -128) become a plain SIMD deinterleave.
+    LetterboxTransform toQuantized(const cv::Mat& src, cv::Size netSize, uint8_t* dst,
+                                   float scale, int zeroPoint, bool isSigned);
+
+    // Letterboxes into an 8-bit RGB image of netSize. Engines treat such an
+    // image as already letterboxed (identity transform), so this lets callers
+    // downscale on their own thread and hand a small frame to inference.
+    LetterboxTransform toImage(const cv::Mat& src, cv::Size netSize, cv::Mat& dst);
+
+    // Ultralytics pad colour (114, 114, 114)
+    static constexpr uint8_t kPadValue = 114;
+
+private:
+    enum class QuantMapping { Identity, FlipSign, Table };
+
+    const cv::Mat& resizeInner(const cv::Mat& src, cv::Size netSize, LetterboxTransform& t, cv::Rect& inner);
+    void updateQuantTable(float scale, int zeroPoint, bool isSigned);
+
+    cv::Mat resized;
+    cv::Mat rowScratch; // 3 x netWidth floats, used by the fp16 path
+
+    // pixel -> quantized value, rebuilt only when the parameters change
+    uint8_t quantTable[256];
+    QuantMapping quantMapping = QuantMapping::Identity;
+    float quantScale = 0.0f;
+    int quantZeroPoint = 0;
+    bool quantSigned = false;
+};
@@ -0,0 +1,157 @@
+#include "ModelMetadata.h"
+#include "../../utils/log.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+
+using namespace std;
+
+namespace {
+
+const vector<string> kCocoClassNames = {
+    "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat", "traffic light",
+    "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat", "dog", "horse", "sheep", "cow",
+    "elephant", "bear", "zebra", "giraffe", "backpack", "umbrella", "handbag", "tie", "suitcase", "frisbee",
+    "skis", "snowboard", "sports ball", "kite", "baseball bat", "baseball glove", "skateboard", "surfboard",
+    "tennis racket", "bottle", "wine glass", "cup", "fork", "knife", "spoon", "bowl", "banana", "apple",
+    "sandwich", "orange", "broccoli", "carrot", "hot dog", "pizza", "donut", "cake", "chair", "couch",
+    "potted plant", "bed", "dining table", "toilet", "tv", "laptop", "mouse", "remote", "keyboard", "cell phone",
+    "microwave", "oven", "toaster", "sink", "refrigerator", "book", "clock", "vase", "scissors", "teddy bear",
+    "hair drier", "toothbrush"
+};
+
+// ModelProto field numbers and protobuf wire types
+constexpr uint32_t kMetadataPropsField = 14;
+constexpr uint32_t kVarint = 0, kFixed64 = 1, kLengthDelimited = 2, kFixed32 = 5;
+
+bool readVarint(istream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Skips one field's payload; false on truncated or unknown wire types
+bool skipField(istream& in, uint32_t wireType) {
+    uint64_t value;
+    switch (wireType) {
+        case kVarint: return readVarint(in, value);
+        case kFixed64: in.seekg(8, ios::cur); return (bool)in;
+        case kFixed32: in.seekg(4, ios::cur); return (bool)in;
+        case kLengthDelimited:
+            if (!readVarint(in, value)) return false;
+            in.seekg((streamoff)value, ios::cur);
+            return (bool)in;
+        default: return false;
+    }
+}
+
+// StringStringEntryProto { string key = 1; string value = 2; }
+bool readEntry(istream& in, uint64_t length, string& key, string& value) {
+    const streampos end = in.tellg() + (streamoff)length;
+    while (in && in.tellg() < end) {
+        uint64_t tag, size;
+        if (!readVarint(in, tag)) return false;
+        const uint32_t field = (uint32_t)(tag >> 3), wireType = (uint32_t)(tag & 7);
+        if (wireType != kLengthDelimited || (field != 1 && field != 2)) {
+            if (!skipField(in, wireType)) return false;
+            continue;
+        }
+        if (!readVarint(in, size)) return false;
+        string& dst = field == 1 ? key : value;
+        dst.resize((size_t)size);
+        in.read(&dst[0], (streamsize)size);
+    }
+    return (bool)in;
+}
+
+vector<string> readSidecar(const string& path) {
+    vector<string> names;
+    ifstream file(path);
+    string line;
+    while (getline(file, line)) {
+        while (!line.empty() && isspace((unsigned char)line.back())) line.pop_back();
+        if (!line.empty()) names.push_back(line);
+    }
+    return names;
+}
+
+} // namespace
+
+map<string, string> readOnnxMetadata(const string& modelPath) {
+    map<string, string> metadata;
+    ifstream in(modelPath, ios::binary);
+    uint64_t tag;
+    while (in && readVarint(in, tag)) {
+        const uint32_t field = (uint32_t)(tag >> 3), wireType = (uint32_t)(tag & 7);
+        if (field == kMetadataPropsField && wireType == kLengthDelimited) {
+            uint64_t length;
+            string key, value;
+            if (!readVarint(in, length) || !readEntry(in, length, key, value)) break;
+            metadata[key] = value;
+        } else if (!skipField(in, wireType)) {
+            break;
+        }
+    }
+    return metadata;
+}
+
+vector<string> parseClassNames(const string& names) {
+    vector<string> result;
+    size_t pos = 0;
+    while (pos < names.size()) {
+        // <id>: '<name>' (or "<name>" when the name itself holds a quote)
+        while (pos < names.size() && !isdigit((unsigned char)names[pos])) pos++;
+        if (pos >= names.size()) break;
+        size_t idEnd = pos;
+        while (idEnd < names.size() && isdigit((unsigned char)names[idEnd])) idEnd++;
+        if (idEnd - pos > 5) break; // not a class list; also keeps strtoul in range
+        const size_t id = strtoul(names.c_str() + pos, nullptr, 10);
+        size_t quote = names.find_first_of("'\"", idEnd);
+        if (quote == string::npos) break;
+        const char q = names[quote];
+        string name;
+        for (pos = quote + 1; pos < names.size() && names[pos] != q; ++pos) {
+            if (names[pos] == '\\' && pos + 1 < names.size()) pos++;
+            name += names[pos];
+        }
+        pos++;
+        if (id >= result.size()) result.resize(id + 1);
+        result[id] = name;
+    }
+    return result;
+}
+
+vector<string> loadClassNames(const string& modelPath, const string& namesMetadata) {
+    if (!namesMetadata.empty()) {
+        vector<string> parsed = parseClassNames(namesMetadata);
+        if (!parsed.empty()) {
+            LOGD("ModelMetadata", "%zu class names from model metadata", parsed.size());
+            return parsed;
+        }
+    }
+
+    const size_t slash = modelPath.find_last_of('/');
+    size_t dot = modelPath.find_last_of('.');
+    if (slash != string::npos && dot != string::npos && dot < slash) dot = string::npos;
+    const string stem = dot == string::npos ? modelPath : modelPath.substr(0, dot);
+    for (const char* ext : {".names", ".txt"}) {
+        vector<string> sidecar = readSidecar(stem + ext);
+        if (!sidecar.empty()) {
+            LOGD("ModelMetadata", "%zu class names from %s%s", sidecar.size(), stem.c_str(), ext);
+            return sidecar;
+        }
+    }
+    return kCocoClassNames;
+}
+
+vector<string> loadClassNames(const string& modelPath) {
+    auto metadata = readOnnxMetadata(modelPath);
+    auto names = metadata.find("names");
+    return loadClassNames(modelPath, names != metadata.end() ? names->second : string());
+}
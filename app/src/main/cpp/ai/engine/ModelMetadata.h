@@ -0,0 +1,23 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+// Reads the metadata_props key/value pairs of an ONNX model without a
+// runtime: only the top-level ModelProto fields are walked and the graph is
+// skipped by length, so this is cheap even for large models. Only for
+// engines with no metadata API of their own (OpenCV DNN); ORT sessions read
+// it through Ort::ModelMetadata.
+std::map<std::string, std::string> readOnnxMetadata(const std::string& modelPath);
+
+// Parses Ultralytics' "names" metadata, a Python dict literal such as
+// "{0: 'person', 1: 'bicycle'}". Missing ids are left empty.
+std::vector<std::string> parseClassNames(const std::string& names);
+
+// Class names for a model, in order of preference: its "names" metadata
+// entry (empty if it has none), a sidecar "<model>.names" / "<model>.txt"
+// file with one name per line, then the 80 COCO classes.
+std::vector<std::string> loadClassNames(const std::string& modelPath, const std::string& namesMetadata);
+
+// Same, with the metadata entry read by readOnnxMetadata
+std::vector<std::string> loadClassNames(const std::string& modelPath);
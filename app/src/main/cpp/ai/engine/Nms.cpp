@@ -0,0 +1,107 @@
+#include "Nms.h"
+#include "../../utils/profiler.h"
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <numeric>
+
+using namespace cv;
+using namespace std;
+
+void DetectionCandidates::clear() {
+    left.clear();
+    top.clear();
+    width.clear();
+    height.clear();
+    score.clear();
+    classId.clear();
+}
+
+void DetectionCandidates::push(float l, float t, float w, float h, float s, int cls) {
+    left.push_back(l);
+    top.push_back(t);
+    width.push_back(w);
+    height.push_back(h);
+    score.push_back(s);
+    classId.push_back(cls);
+}
+
+void Nms::run(const DetectionCandidates& candidates, float iouThreshold, const NmsConfig& config, vector<int>& keep) {
+    PROFILE_STAGE(Stage::Nms);
+    keep.clear();
+    const int total = (int)candidates.size();
+    if (total == 0) return;
+
+    // Pre-sort, keeping only the top K: low-threshold frames can carry thousands
+    order.resize(total);
+    iota(order.begin(), order.end(), 0);
+    const int count = config.maxCandidates > 0 ? min(total, config.maxCandidates) : total;
+    const auto byScore = [&](int a, int b) { return candidates.score[a] > candidates.score[b]; };
+    partial_sort(order.begin(), order.begin() + count, order.end(), byScore);
+
+    x1.resize(count);
+    y1.resize(count);
+    x2.resize(count);
+    y2.resize(count);
+    area.resize(count);
+    cls.resize(count);
+    for (int k = 0; k < count; ++k) {
+        const int idx = order[k];
+        x1[k] = candidates.left[idx];
+        y1[k] = candidates.top[idx];
+        x2[k] = candidates.left[idx] + candidates.width[idx];
+        y2[k] = candidates.top[idx] + candidates.height[idx];
+        area[k] = candidates.width[idx] * candidates.height[idx];
+        cls[k] = candidates.classId[idx];
+    }
+    removed.assign(count, 0);
+
+    const int maxDetections = config.maxDetections > 0 ? config.maxDetections : count;
+    for (int i = 0; i < count && (int)keep.size() < maxDetections; ++i) {
+        if (removed[i]) continue;
+        keep.push_back(order[i]);
+        suppressFrom(i, count, iouThreshold, config);
+    }
+}
+
+// Marks every later box overlapping box i too much. IoU > t is evaluated as
+// inter > t * union to stay division-free.
+void Nms::suppressFrom(int i, int count, float iouThreshold, const NmsConfig& config) {
+    const float bx1 = x1[i], by1 = y1[i], bx2 = x2[i], by2 = y2[i], barea = area[i];
+    const int bcls = cls[i];
+    const float contain = config.containmentThreshold;
+    int j = i + 1;
+#if CV_SIMD128
+    const v_float32x4 vx1 = v_setall_f32(bx1), vy1 = v_setall_f32(by1);
+    const v_float32x4 vx2 = v_setall_f32(bx2), vy2 = v_setall_f32(by2);
+    const v_float32x4 varea = v_setall_f32(barea), zero = v_setzero_f32();
+    const v_float32x4 vthr = v_setall_f32(iouThreshold), vcontain = v_setall_f32(contain);
+    const v_int32x4 vcls = v_setall_s32(bcls);
+    for (; j <= count - 4; j += 4) {
+        v_float32x4 w = v_max(v_min(vx2, v_load(&x2[j])) - v_max(vx1, v_load(&x1[j])), zero);
+        v_float32x4 h = v_max(v_min(vy2, v_load(&y2[j])) - v_max(vy1, v_load(&y1[j])), zero);
+        v_float32x4 inter = w * h;
+        v_float32x4 otherArea = v_load(&area[j]);
+        v_float32x4 overlap = inter > vthr * (varea + otherArea - inter);
+        if (contain > 0) overlap = overlap | (inter > vcontain * v_min(varea, otherArea));
+        if (!config.classAgnostic) {
+            overlap = overlap & v_reinterpret_as_f32(v_load(&cls[j]) == vcls);
+        }
+        const int bits = v_signmask(overlap);
+        if (bits == 0) continue;
+        for (int k = 0; k < 4; ++k) {
+            if (bits & (1 << k)) removed[j + k] = 1;
+        }
+    }
+#endif
+    for (; j < count; ++j) {
+        if (!config.classAgnostic && cls[j] != bcls) continue;
+        float w = max(min(bx2, x2[j]) - max(bx1, x1[j]), 0.0f);
+        float h = max(min(by2, y2[j]) - max(by1, y1[j]), 0.0f);
+        float inter = w * h;
+        if (inter > iouThreshold * (barea + area[j] - inter) ||
+            (contain > 0 && inter > contain * min(barea, area[j]))) {
+            removed[j] = 1;
+        }
+    }
+}
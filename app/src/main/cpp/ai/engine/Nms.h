@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Detection candidates in structure-of-arrays form, boxes in source pixels.
+// Buffers keep their capacity across frames.
+struct DetectionCandidates {
+    std::vector<float> left;
+    std::vector<float> top;
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<float> score;
+    std::vector<int> classId;
+
+    size_t size() const { return score.size(); }
+    void clear();
+    void push(float l, float t, float w, float h, float s, int cls);
+};
+
+struct NmsConfig {
+    bool classAgnostic = false;       // false: boxes only suppress boxes of their own class
+    int maxCandidates = 1024;         // top-K by score kept before suppression
+    int maxDetections = 300;          // stop once this many boxes survive
+    float containmentThreshold = 0.0f; // also drop boxes this much inside a kept one (0 = off)
+};
+
+// Greedy non-maximum suppression over float boxes. Candidates are sorted by
+// score (capped to the top K), gathered into corner-form arrays, and each kept
+// box is tested against the remaining ones four at a time.
+class Nms {
+public:
+    // Writes indices into `candidates` of the surviving boxes, best score first
+    void run(const DetectionCandidates& candidates, float iouThreshold, const NmsConfig& config,
+             std::vector<int>& keep);
+
+private:
+    void suppressFrom(int i, int count, float iouThreshold, const NmsConfig& config);
+
+    std::vector<int> order;
+    std::vector<float> x1, y1, x2, y2, area;
+    std::vector<int> cls;
+    std::vector<uint8_t> removed;
+};
@@ -1,27 +1,236 @@
 #include "OrtEngine.h"
-#include <android/log.h>
+#include "ModelMetadata.h"
+#include "../../utils/log.h"
+#include "../../utils/profiler.h"
+#include "../../utils/threadpool.h"
 #include <opencv2/imgproc.hpp>
-#include <opencv2/dnn.hpp>
 #include <onnxruntime_float16.h>
-#include <set>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#ifdef __ANDROID__
+#include <nnapi_provider_factory.h>
+#endif
 
 using namespace cv;
 using namespace std;
 
-OrtEngine::OrtEngine() : env(ORT_LOGGING_LEVEL_WARNING, "OrtEngine") {}
+namespace {
+
+bool providerAvailable(const char* name) {
+    auto providers = Ort::GetAvailableProviders();
+    return find(providers.begin(), providers.end(), name) != providers.end();
+}
+
+int defaultIntraOpThreads() {
+    // Same width as the filter pool: one thread per performance core, since
+    // threads parked on little cores stall every op barrier
+    return sharedThreadPool()->size();
+}
+
+// ORT's global intra-op threads start through here so they get the same
+// core affinity as the shared pool's workers
+OrtCustomThreadHandle createPoolThread(void*, OrtThreadWorkerFn work, void* param) {
+    vector<int> cpus = sharedThreadPool()->cpus();
+    auto* worker = new thread([cpus, work, param] {
+        pinCurrentThread(cpus);
+        work(param);
+    });
+    return reinterpret_cast<OrtCustomThreadHandle>(worker);
+}
+
+void joinPoolThread(OrtCustomThreadHandle handle) {
+    auto* worker = reinterpret_cast<thread*>(const_cast<OrtCustomHandleType*>(handle));
+    worker->join();
+    delete worker;
+}
+
+// Process-wide env with one global intra-op pool sized like the filter pool.
+// Its threads never spin, so between inferences they leave the cores to
+// filter row bands instead of busy-waiting next to them. ORT fixes the pool
+// on first use. Intentionally leaked: engines held by namespace-scope
+// statics (aiController) outlive any function-local static built after them.
+Ort::Env& sharedEnv() {
+    static Ort::Env* env = [] {
+        Ort::ThreadingOptions threading;
+        threading.SetGlobalIntraOpNumThreads(defaultIntraOpThreads());
+        threading.SetGlobalInterOpNumThreads(1);
+        threading.SetGlobalSpinControl(0);
+        threading.SetGlobalCustomCreateThreadFn(createPoolThread);
+        threading.SetGlobalCustomJoinThreadFn(joinPoolThread);
+        return new Ort::Env(threading, ORT_LOGGING_LEVEL_WARNING, "OrtEngine");
+    }();
+    return *env;
+}
+
+// FNV-1a over the model bytes; only has to tell model files apart
+uint64_t hashFile(const string& path) {
+    uint64_t hash = 1469598103934665603ULL;
+    ifstream file(path, ios::binary);
+    vector<char> chunk(1 << 16);
+    while (file.read(chunk.data(), chunk.size()) || file.gcount() > 0) {
+        for (streamsize i = 0; i < file.gcount(); ++i) {
+            hash = (hash ^ (uint8_t)chunk[i]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+uint64_t hashString(uint64_t hash, const string& text) {
+    for (char c : text) hash = (hash ^ (uint8_t)c) * 1099511628211ULL;
+    return hash;
+}
+
+bool fileExists(const string& path) {
+    return ifstream(path).good();
+}
+
+bool isQuantized(ONNXTensorElementDataType type) {
+    return type == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8 || type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8;
+}
+
+size_t elementSize(ONNXTensorElementDataType type) {
+    switch (type) {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT: return 4;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16: return 2;
+        default: return 1;
+    }
+}
+
+// Optional custom metadata entry as a string, empty when missing
+string metadataString(const Ort::ModelMetadata& metadata, const char* key) {
+    Ort::AllocatorWithDefaultOptions allocator;
+    auto entry = metadata.LookupCustomMetadataMapAllocated(key, allocator);
+    return entry ? string(entry.get()) : string();
+}
+
+// Optional custom metadata entry parsed as a number
+bool metadataNumber(const Ort::ModelMetadata& metadata, const char* key, float& value) {
+    Ort::AllocatorWithDefaultOptions allocator;
+    auto entry = metadata.LookupCustomMetadataMapAllocated(key, allocator);
+    if (!entry) return false;
+    char* end = nullptr;
+    float parsed = strtof(entry.get(), &end);
+    if (end == entry.get()) return false;
+    value = parsed;
+    return true;
+}
+
+// Graph transformers applied when building from the original model; part of
+// the optimized-graph cache key
+constexpr GraphOptimizationLevel kGraphOptimization = GraphOptimizationLevel::ORT_ENABLE_ALL;
+
+} // namespace
+
+OrtEngine::OrtEngine() : env(sharedEnv()) {}
 
 OrtEngine::~OrtEngine() {
-    if (session) delete session;
-    if (sessionOptions) delete sessionOptions;
+    releaseBindings();
+}
+
+Ort::SessionOptions OrtEngine::buildSessionOptions() const {
+    Ort::SessionOptions options;
+    const int intraThreads = config.intraOpThreads > 0 ? config.intraOpThreads : defaultIntraOpThreads();
+    options.SetGraphOptimizationLevel(kGraphOptimization);
+    options.SetExecutionMode(config.parallelExecution ? ExecutionMode::ORT_PARALLEL : ExecutionMode::ORT_SEQUENTIAL);
+    options.SetInterOpNumThreads(max(1, config.interOpThreads));
+    options.AddConfigEntry("session.intra_op.allow_spinning", config.allowSpinning ? "1" : "0");
+
+    if (config.provider == "XNNPACK" && providerAvailable("XnnpackExecutionProvider")) {
+        // XNNPACK runs its own pool; ORT's intra-op pool would only compete with it
+        options.SetIntraOpNumThreads(1);
+        options.AppendExecutionProvider("XNNPACK", {{"intra_op_num_threads", to_string(intraThreads)}});
+        return options;
+    }
+    if (config.sharedThreadPool) {
+        options.DisablePerSessionThreads();
+    } else {
+        options.SetIntraOpNumThreads(intraThreads);
+    }
+#ifdef __ANDROID__
+    if (config.provider == "NNAPI" && providerAvailable("NnapiExecutionProvider")) {
+        Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_Nnapi(options, NNAPI_FLAG_USE_FP16));
+        return options;
+    }
+#endif
+    if (config.provider != "CPU") {
+        LOGW("OrtEngine", "Execution provider %s unavailable, using CPU", config.provider.c_str());
+    }
+    return options;
+}
+
+void OrtEngine::setSessionConfig(const OrtSessionConfig& newConfig) {
+    const OrtSessionConfig previous = config;
+    config = newConfig;
+    LOGI("OrtEngine", "Session config: provider=%s intra=%d inter=%d spin=%d parallel=%d shared=%d",
+         config.provider.c_str(), config.intraOpThreads, config.interOpThreads,
+         config.allowSpinning, config.parallelExecution, config.sharedThreadPool);
+    if (modelPath.empty() || loadModel(modelPath)) return;
+    // e.g. a provider the device rejects: the old session is still live, keep its settings
+    LOGW("OrtEngine", "Session config rejected, keeping provider %s", previous.provider.c_str());
+    config = previous;
 }
 
-bool OrtEngine::loadModel(const std::string& modelPath) {
+std::string OrtEngine::optimizedModelPath(const std::string& path) {
+    // Saved graphs are specialized to the provider; only the CPU graph is portable
+    // enough to reuse, and NNAPI-compiled nodes cannot be serialized at all
+    if (cacheDir.empty() || config.provider != "CPU") return "";
+    if (hashedModelPath != path) {
+        modelHash = hashFile(path);
+        hashedModelPath = path;
+    }
+    // Key: model bytes, runtime version and every session option that feeds
+    // buildSessionOptions, so an ORT upgrade or a settings change never picks
+    // up a graph serialized under different options
+    uint64_t key = hashString(modelHash, Ort::GetVersionString());
+    char options[160];
+    snprintf(options, sizeof(options), "opt=%d;provider=%s;mode=%d;inter=%d;spin=%d;shared=%d",
+             (int)kGraphOptimization, config.provider.c_str(), config.parallelExecution ? 1 : 0,
+             max(1, config.interOpThreads), config.allowSpinning ? 1 : 0, config.sharedThreadPool ? 1 : 0);
+    key = hashString(key, options);
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return cacheDir + "/ort-" + name + ".onnx";
+}
+
+unique_ptr<Ort::Session> OrtEngine::createSession(const std::string& path) {
+    Ort::SessionOptions sessionOptions = buildSessionOptions();
+    const string cached = optimizedModelPath(path);
+    if (!cached.empty() && fileExists(cached)) {
+        try {
+            // Already optimized offline, skip the graph transformers
+            sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+            auto created = make_unique<Ort::Session>(env, cached.c_str(), sessionOptions);
+            LOGD("OrtEngine", "Loaded optimized model from cache: %s", cached.c_str());
+            return created;
+        } catch (const Ort::Exception& e) {
+            // Truncated or stale cache file: drop it and rebuild from the original model
+            LOGW("OrtEngine", "Discarding model cache %s: %s", cached.c_str(), e.what());
+            remove(cached.c_str());
+            sessionOptions = buildSessionOptions();
+        }
+    }
+    if (!cached.empty()) sessionOptions.SetOptimizedModelFilePath(cached.c_str());
+    return make_unique<Ort::Session>(env, path.c_str(), sessionOptions);
+}
+
+bool OrtEngine::loadModel(const std::string& path) {
+    // Build the new session first: if the options are rejected, the working
+    // session and its bindings stay untouched
+    unique_ptr<Ort::Session> created;
     try {
-        sessionOptions = new Ort::SessionOptions();
-        sessionOptions->SetIntraOpNumThreads(4);
-        sessionOptions->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        created = createSession(path);
+    } catch (const Ort::Exception& e) {
+        LOGE("OrtEngine", "Session creation failed for %s: %s", path.c_str(), e.what());
+        return false;
+    }
 
-        session = new Ort::Session(env, modelPath.c_str(), *sessionOptions);
+    modelPath = path;
+    try {
+        releaseBindings();
+        session = std::move(created);
 
         Ort::AllocatorWithDefaultOptions allocator;
         inputNames.clear();
@@ -33,151 +242,267 @@ bool OrtEngine::loadModel(const std::string& modelPath) {
         for (size_t i = 0; i < numInputNodes; i++) {
             auto name = session->GetInputNameAllocated(i, allocator);
             inputNameStrings.push_back(name.get());
-            inputNames.push_back(inputNameStrings.back().c_str());
         }
 
         size_t numOutputNodes = session->GetOutputCount();
         for (size_t i = 0; i < numOutputNodes; i++) {
             auto name = session->GetOutputNameAllocated(i, allocator);
             outputNameStrings.push_back(name.get());
-            outputNames.push_back(outputNameStrings.back().c_str());
         }
 
+        // Take c_str() only once the string vectors stop growing
+        for (const auto& name : inputNameStrings) inputNames.push_back(name.c_str());
+        for (const auto& name : outputNameStrings) outputNames.push_back(name.c_str());
+
+        resolveMetadata();
+        bindBuffers();
+        classNames = loadClassNames(modelPath, metadataString(session->GetModelMetadata(), "names"));
+
         isLoaded = true;
-        __android_log_print(ANDROID_LOG_DEBUG, "OrtEngine", "Model loaded: %s", modelPath.c_str());
-    } catch (const Ort::Exception& e) {
-        __android_log_print(ANDROID_LOG_ERROR, "OrtEngine", "Load error: %s", e.what());
+        LOGD("OrtEngine", "Model loaded: %s (input %lldx%lld, output [%lld, %lld])", modelPath.c_str(),
+             (long long)inputShape[3], (long long)inputShape[2], (long long)outputShape[1], (long long)outputShape[2]);
+    } catch (const std::exception& e) {
+        LOGE("OrtEngine", "Load error: %s", e.what());
+        releaseBindings();
+        session.reset();
         isLoaded = false;
     }
     return isLoaded;
 }
 
+void OrtEngine::resolveMetadata() {
+    auto inputInfo = session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo();
+    inputType = inputInfo.GetElementType();
+    if (inputType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT && inputType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 &&
+        !isQuantized(inputType)) {
+        throw Ort::Exception("Unsupported input element type", ORT_INVALID_ARGUMENT);
+    }
+
+    // Dynamic dims (-1) fall back to batch 1 and the default 640x640 input
+    inputShape = inputInfo.GetShape();
+    if (inputShape.size() != 4) throw Ort::Exception("Expected NCHW input", ORT_INVALID_ARGUMENT);
+    dynamicBatch = inputShape[0] <= 0;
+    inputShape[0] = 1;
+    inputShape[1] = 3;
+    if (inputShape[2] <= 0) inputShape[2] = 640;
+    if (inputShape[3] <= 0) inputShape[3] = 640;
+    netSize = Size((int)inputShape[3], (int)inputShape[2]);
+
+    auto outputInfo = session->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo();
+    outputType = outputInfo.GetElementType();
+    if (outputType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT && outputType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 &&
+        !isQuantized(outputType)) {
+        throw Ort::Exception("Unsupported output element type", ORT_INVALID_ARGUMENT);
+    }
+    outputShape = outputInfo.GetShape();
+    if (outputShape.size() != 3) throw Ort::Exception("Expected [1, 4+nc, anchors] output", ORT_INVALID_ARGUMENT);
+    outputShape[0] = 1;
+
+    resolveQuantization();
+}
+
+void OrtEngine::resolveQuantization() {
+    // Graph inputs/outputs carry no scale of their own; exporters that quantize
+    // them record it as custom metadata. Without it, uint8/int8 input is taken
+    // to be raw pixels (scale 1/255, shifted by -128 for int8).
+    const bool signedInput = inputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8;
+    inputQuant.scale = 1.0f / 255.0f;
+    inputQuant.zeroPoint = signedInput ? -128 : 0;
+    outputQuant = QuantParams();
+    if (!isQuantized(inputType) && !isQuantized(outputType)) return;
+
+    Ort::ModelMetadata metadata = session->GetModelMetadata();
+    float value;
+    if (metadataNumber(metadata, "input_scale", value) && value > 0) inputQuant.scale = value;
+    if (metadataNumber(metadata, "input_zero_point", value)) inputQuant.zeroPoint = (int)value;
+    bool hasOutputScale = metadataNumber(metadata, "output_scale", value) && value > 0;
+    if (hasOutputScale) outputQuant.scale = value;
+    if (metadataNumber(metadata, "output_zero_point", value)) outputQuant.zeroPoint = (int)value;
+
+    if (isQuantized(outputType) && !hasOutputScale) {
+        LOGW("OrtEngine", "Quantized output without output_scale metadata, assuming scale 1");
+    }
+    LOGD("OrtEngine", "Quantization: input scale %g zp %d, output scale %g zp %d",
+         inputQuant.scale, inputQuant.zeroPoint, outputQuant.scale, outputQuant.zeroPoint);
+}
+
+void OrtEngine::bindBuffers() {
+    memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    runOptions = Ort::RunOptions();
+    releaseBindings();
+    batchCapacity = 0;
+    if (outputShape[1] <= 0 || outputShape[2] <= 0) resolveOutputShape();
+    bindBatch(1);
+}
+
+// Dynamic output dims: run once with ORT-allocated output to learn the real shape
+void OrtEngine::resolveOutputShape() {
+    const size_t inputCount = (size_t)3 * netSize.area();
+    vector<uint8_t> zeros(inputCount * elementSize(inputType), 0);
+    Ort::Value probe = Ort::Value::CreateTensor(memoryInfo, zeros.data(), zeros.size(),
+                                                inputShape.data(), inputShape.size(), inputType);
+    Ort::IoBinding probeBinding(*session);
+    probeBinding.BindInput(inputNames[0], probe);
+    probeBinding.BindOutput(outputNames[0], memoryInfo);
+    session->Run(runOptions, probeBinding);
+    outputShape = probeBinding.GetOutputValues()[0].GetTensorTypeAndShapeInfo().GetShape();
+    outputShape[0] = 1;
+}
+
+// Grows the I/O buffers to hold `batch` images. Existing bindings point into
+// the old buffers, so both are rebuilt on their next use.
+void OrtEngine::reserveBatch(int batch) {
+    const size_t inputSize = (size_t)batch * 3 * netSize.area();
+    if (inputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+        inputTensorFp16.assign(inputSize, 0);
+    } else if (isQuantized(inputType)) {
+        inputTensorQuant.assign(inputSize, 0);
+    } else {
+        inputTensorValues.assign(inputSize, 0.0f);
+    }
+    const size_t outputCount = (size_t)(batch * outputShape[1] * outputShape[2]);
+    outputValues.assign(outputCount, 0.0f);
+    // fp16/quantized output lands in outputRaw and is widened to float32 after each run
+    if (outputType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) outputRaw.assign(outputCount * elementSize(outputType), 0);
+    batchCapacity = batch;
+    releaseBindings();
+}
+
+void OrtEngine::buildBinding(BatchBinding& slot, int batch) {
+    slot.binding = Ort::IoBinding(*session);
+    vector<int64_t> shape = inputShape;
+    shape[0] = batch;
+    const size_t inputSize = (size_t)batch * 3 * netSize.area();
+    if (inputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+        slot.input = Ort::Value::CreateTensor<Ort::Float16_t>(memoryInfo,
+            reinterpret_cast<Ort::Float16_t*>(inputTensorFp16.data()), inputSize, shape.data(), shape.size());
+    } else if (isQuantized(inputType)) {
+        slot.input = Ort::Value::CreateTensor(memoryInfo, inputTensorQuant.data(), inputSize,
+                                              shape.data(), shape.size(), inputType);
+    } else {
+        slot.input = Ort::Value::CreateTensor<float>(memoryInfo, inputTensorValues.data(), inputSize, shape.data(), shape.size());
+    }
+    slot.binding.BindInput(inputNames[0], slot.input);
+
+    shape = outputShape;
+    shape[0] = batch;
+    const size_t outputCount = (size_t)(batch * outputShape[1] * outputShape[2]);
+    if (outputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+        slot.output = Ort::Value::CreateTensor<float>(memoryInfo, outputValues.data(), outputCount, shape.data(), shape.size());
+    } else {
+        slot.output = Ort::Value::CreateTensor(memoryInfo, outputRaw.data(), outputCount * elementSize(outputType),
+                                               shape.data(), shape.size(), outputType);
+    }
+    slot.binding.BindOutput(outputNames[0], slot.output);
+    slot.batch = batch;
+    bufferAllocations++;
+}
+
+void OrtEngine::bindBatch(int batch) {
+    if (batch > batchCapacity) reserveBatch(batch);
+    BatchBinding& slot = batch == 1 ? singleBinding : batchedBinding;
+    if (slot.batch != batch) buildBinding(slot, batch);
+    activeBinding = &slot;
+}
+
+void OrtEngine::dequantizeOutput() {
+    const int count = (int)(activeBinding->batch * outputShape[1] * outputShape[2]);
+    Mat dst(1, count, CV_32F, outputValues.data());
+    switch (outputType) {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+            Mat(1, count, CV_16F, outputRaw.data()).convertTo(dst, CV_32F);
+            break;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8: {
+            // real = (q - zp) * scale, as one vectorized convertTo
+            const int depth = outputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8 ? CV_8S : CV_8U;
+            Mat(1, count, depth, outputRaw.data()).convertTo(dst, CV_32F, outputQuant.scale,
+                                                              -outputQuant.zeroPoint * outputQuant.scale);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void OrtEngine::releaseBindings() {
+    // Bindings reference the session and the buffers, drop them before either goes away
+    singleBinding = BatchBinding();
+    batchedBinding = BatchBinding();
+    activeBinding = nullptr;
+}
+
 void OrtEngine::setBackend(const std::string& backend) {
-    // Note: To change backend in ORT, we typically need to recreate the session with new options.
-    // For simplicity, we just log here. To fully support NNAPI switch at runtime, we'd need to reload the model.
-    // However, usually backend is set before loading. 
-    // If the user switches backend at runtime, we should reload if we stored the model path.
-    // But Engine interface doesn't store path.
-    // We'll rely on the caller re-initializing or accept that this only affects *next* load? 
-    // Or we assume this is called *before* loadModel in a real app, or we just ignore for now as ORT NNAPI requires build time flags or specific provider options during Session creation.
-    // We added NNAPI flags to CMake, so it's available.
-    __android_log_print(ANDROID_LOG_INFO, "OrtEngine", "Backend switch request to %s (requires reload for ORT)", backend.c_str());
+    // Providers are fixed at session creation, so a switch rebuilds the session
+    OrtSessionConfig next = config;
+    // UI labels look like "NPU (NNAPI)"
+    if (backend.find("NNAPI") != string::npos) {
+        next.provider = "NNAPI";
+    } else if (backend.find("XNNPACK") != string::npos) {
+        next.provider = "XNNPACK";
+    } else {
+        next.provider = "CPU";
+    }
+    if (next.provider == config.provider) return;
+    setSessionConfig(next);
+}
+
+LetterboxTransform OrtEngine::preprocess(const Mat& input, int slot) {
+    // Letterbox + normalize + HWC->CHW in one pass, straight into the bound input buffer
+    const size_t offset = (size_t)slot * 3 * netSize.area();
+    if (inputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+        return preprocessor.toFloat16(input, netSize, inputTensorFp16.data() + offset);
+    }
+    if (isQuantized(inputType)) {
+        // 8-bit pixels go in as 8-bit values, no float round trip
+        return preprocessor.toQuantized(input, netSize, inputTensorQuant.data() + offset, inputQuant.scale,
+                                        inputQuant.zeroPoint, inputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8);
+    }
+    return preprocessor.toFloat32(input, netSize, inputTensorValues.data() + offset);
+}
+
+void OrtEngine::run() {
+    PROFILE_STAGE(Stage::Inference);
+    session->Run(runOptions, activeBinding->binding);
+    if (outputType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) dequantizeOutput();
 }
 
 vector<YoloResult> OrtEngine::detect(const Mat& input, float confThreshold, float iouThreshold, const vector<int>& allowedClasses) {
     vector<YoloResult> results;
     if (!isLoaded || input.empty()) return results;
 
-    Mat rgb;
-    if (input.channels() == 4) cvtColor(input, rgb, COLOR_RGBA2RGB);
-    else rgb = input;
-
-    Mat resized;
-    resize(rgb, resized, Size(640, 640));
-    resized.convertTo(resized, CV_32FC3, 1.0 / 255.0);
-
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    int64_t inputShape[] = {1, 3, 640, 640};
-
-    // Check input type
-    auto input_type_info = session->GetInputTypeInfo(0);
-    auto input_tensor_info = input_type_info.GetTensorTypeAndShapeInfo();
-    ONNXTensorElementDataType expected_type = input_tensor_info.GetElementType();
-
-    Ort::Value inputTensor(nullptr);
-
-    if (expected_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
-        vector<uint16_t> fp16_values(1 * 3 * 640 * 640);
-        for (int c = 0; c < 3; ++c) {
-            for (int h = 0; h < 640; ++h) {
-                for (int w = 0; w < 640; ++w) {
-                    float val = resized.at<Vec3f>(h, w)[c];
-                    fp16_values[c * 640 * 640 + h * 640 + w] = Ort::Float16_t(val).val;
-                }
-            }
-        }
-        inputTensor = Ort::Value::CreateTensor<Ort::Float16_t>(memory_info, 
-            reinterpret_cast<Ort::Float16_t*>(fp16_values.data()), fp16_values.size(), inputShape, 4);
-    } else {
-        vector<float> inputTensorValues(1 * 3 * 640 * 640);
-        for (int c = 0; c < 3; ++c) {
-            for (int h = 0; h < 640; ++h) {
-                for (int w = 0; w < 640; ++w) {
-                    inputTensorValues[c * 640 * 640 + h * 640 + w] = resized.at<Vec3f>(h, w)[c];
-                }
-            }
-        }
-        inputTensor = Ort::Value::CreateTensor<float>(memory_info, inputTensorValues.data(), inputTensorValues.size(), inputShape, 4);
-    }
+    if (input.depth() != CV_8U || (input.channels() != 3 && input.channels() != 4)) return results;
 
-    auto outputTensors = session->Run(Ort::RunOptions{nullptr}, inputNames.data(), &inputTensor, 1, outputNames.data(), 1);
-    processResults(outputTensors[0], input.cols, input.rows, confThreshold, iouThreshold, allowedClasses, results);
+    bindBatch(1);
+    LetterboxTransform letterbox = preprocess(input, 0);
+    run();
+    decoder.decode(outputValues.data(), (int)outputShape[1], (int)outputShape[2], letterbox,
+                   confThreshold, iouThreshold, allowedClasses, classNames, nmsConfig, results);
 
     return results;
 }
 
-void OrtEngine::processResults(Ort::Value& outputTensor, int imgW, int imgH, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses, std::vector<YoloResult>& results) {
-    float* floatData = outputTensor.GetTensorMutableData<float>();
-    auto outputShape = outputTensor.GetTensorTypeAndShapeInfo().GetShape();
-
-    // shape: [1, 4+nc, anchors] e.g. [1, 84, 8400]
-    int dimensions = (int)outputShape[1]; 
-    int rows = (int)outputShape[2];       
-
-    std::set<int> allowedSet(allowedClasses.begin(), allowedClasses.end());
-    vector<int> class_ids;
-    vector<float> confidences;
-    vector<Rect> boxes;
-
-    float x_factor = (float)imgW / 640.0f;
-    float y_factor = (float)imgH / 640.0f;
-
-    for (int i = 0; i < rows; ++i) {
-        float max_score = 0;
-        int class_id = -1;
-        // classes start at index 4
-        for (int j = 4; j < dimensions; ++j) {
-            float score = floatData[j * rows + i]; // Data is transposed [dim, row] access pattern for typical output
-            if (score > max_score) {
-                max_score = score;
-                class_id = j - 4;
-            }
-        }
-
-        if (max_score > confThreshold) {
-            if (allowedSet.empty() || allowedSet.count(class_id)) {
-                float cx = floatData[0 * rows + i];
-                float cy = floatData[1 * rows + i];
-                float w = floatData[2 * rows + i];
-                float h = floatData[3 * rows + i];
-
-                int left = int((cx - 0.5 * w) * x_factor);
-                int top = int((cy - 0.5 * h) * y_factor);
-                int width = int(w * x_factor);
-                int height = int(h * y_factor);
-
-                boxes.push_back(Rect(left, top, width, height));
-                confidences.push_back(max_score);
-                class_ids.push_back(class_id);
-            }
-        }
+vector<vector<YoloResult>> OrtEngine::detectBatch(const vector<Mat>& images, float confThreshold, float iouThreshold, const vector<int>& allowedClasses) {
+    if (!isLoaded || images.size() <= 1 || !dynamicBatch) {
+        return Engine::detectBatch(images, confThreshold, iouThreshold, allowedClasses);
+    }
+    vector<vector<YoloResult>> results(images.size());
+    for (const auto& image : images) {
+        if (image.empty() || image.depth() != CV_8U || (image.channels() != 3 && image.channels() != 4)) return results;
     }
 
-    vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, confThreshold, iouThreshold, indices);
+    // Rebuilds the batched binding only when the image count changes (i.e. the
+    // frame size does); plain detect keeps its own batch-1 binding meanwhile
+    const int batch = (int)images.size();
+    bindBatch(batch);
+    letterboxes.resize(batch);
+    for (int i = 0; i < batch; ++i) letterboxes[i] = preprocess(images[i], i);
+    run();
 
-    for (int idx : indices) {
-        YoloResult res;
-        int clsId = class_ids[idx];
-        if (clsId >= 0 && clsId < classNames.size()) res.label = classNames[clsId];
-        else res.label = "unknown";
-        
-        res.confidence = confidences[idx];
-        res.x = boxes[idx].x;
-        res.y = boxes[idx].y;
-        res.width = boxes[idx].width;
-        res.height = boxes[idx].height;
-        res.classId = clsId;
-        results.push_back(res);
+    const size_t outputSlice = (size_t)(outputShape[1] * outputShape[2]);
+    for (int i = 0; i < batch; ++i) {
+        decoder.decode(outputValues.data() + i * outputSlice, (int)outputShape[1], (int)outputShape[2], letterboxes[i],
+                       confThreshold, iouThreshold, allowedClasses, classNames, nmsConfig, results[i]);
     }
+    return results;
 }
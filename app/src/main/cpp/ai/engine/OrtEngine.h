@@ -1,7 +1,24 @@
 #pragma once
 #include "Engine.h"
+#include "Letterbox.h"
+#include "YoloDecoder.h"
+#include <memory>
 #include <onnxruntime_cxx_api.h>
 
+// Session-level runtime settings. Changing any of them rebuilds the session
+// from the stored model path.
+struct OrtSessionConfig {
+    int intraOpThreads = 0;        // 0 = pick from the core count
+    int interOpThreads = 1;        // only used with parallelExecution
+    bool allowSpinning = true;     // spin-wait between ops: lower latency, more power
+    bool parallelExecution = false; // ORT_PARALLEL instead of ORT_SEQUENTIAL
+    std::string provider = "CPU";  // "CPU", "XNNPACK", "NNAPI" (Android)
+    // Run on the process-wide intra-op pool shared with the filters (sized and
+    // pinned like sharedThreadPool) instead of a per-session pool. The thread
+    // count and spinning settings above then only apply to XNNPACK.
+    bool sharedThreadPool = true;
+};
+
 class OrtEngine : public Engine {
 public:
     OrtEngine();
@@ -9,16 +26,94 @@ public:
     bool loadModel(const std::string& modelPath) override;
     void setBackend(const std::string& backend) override;
     std::vector<YoloResult> detect(const cv::Mat& input, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses) override;
+    // One Run over all images when the model's batch dimension is dynamic
+    std::vector<std::vector<YoloResult>> detectBatch(const std::vector<cv::Mat>& images, float confThreshold,
+                                                     float iouThreshold, const std::vector<int>& allowedClasses) override;
+    cv::Size inputSize() const override { return netSize; }
+
+    void setSessionConfig(const OrtSessionConfig& config);
+    const OrtSessionConfig& sessionConfig() const { return config; }
+
+    // Directory for optimized-graph caches. Later loads of the same model
+    // with the same settings skip graph optimization. Empty disables it.
+    void setCacheDirectory(const std::string& dir) { cacheDir = dir; }
+
+    // Number of times an I/O binding was built. Batch 1 and the tiled batch
+    // keep bindings of their own over shared buffers, so alternating detect
+    // and detectBatch does not bump it; only loadModel, a larger batch than
+    // before, or a new tiled batch size (new frame size) does.
+    size_t bufferAllocationCount() const { return bufferAllocations; }
 
 private:
-    Ort::Env env;
-    Ort::Session* session = nullptr;
-    Ort::SessionOptions* sessionOptions = nullptr;
+    Ort::Env& env; // process-wide and never destroyed, owns the global thread pool
+    std::unique_ptr<Ort::Session> session;
+    OrtSessionConfig config;
+    std::string modelPath; // kept to rebuild the session on config changes
+    std::string cacheDir;
+    std::string hashedModelPath; // model the cached hash below belongs to
+    uint64_t modelHash = 0;
     std::vector<std::string> inputNameStrings;
     std::vector<std::string> outputNameStrings;
     std::vector<const char*> inputNames;
     std::vector<const char*> outputNames;
     bool isLoaded = false;
 
-    void processResults(Ort::Value& outputTensor, int imgW, int imgH, float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses, std::vector<YoloResult>& results);
+    // Affine quantization of a uint8/int8 tensor: real = (q - zeroPoint) * scale
+    struct QuantParams {
+        float scale = 1.0f;
+        int zeroPoint = 0;
+    };
+
+    // Model metadata, resolved once in loadModel
+    ONNXTensorElementDataType inputType = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    ONNXTensorElementDataType outputType = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    QuantParams inputQuant;  // input real values are pixel / 255
+    QuantParams outputQuant;
+    std::vector<int64_t> inputShape;  // [batch, 3, H, W]
+    std::vector<int64_t> outputShape; // [batch, 4+nc, anchors]
+    bool dynamicBatch = false;
+    cv::Size netSize{640, 640};
+
+    // I/O binding over the first `batch` images of the engine-owned buffers
+    struct BatchBinding {
+        Ort::IoBinding binding{nullptr};
+        Ort::Value input{nullptr};
+        Ort::Value output{nullptr};
+        int batch = 0; // 0 = not built
+    };
+
+    // Persistent I/O bindings over engine-owned buffers, reused frame to frame.
+    // The buffers hold batchCapacity images; both bindings are views into them.
+    Ort::MemoryInfo memoryInfo{nullptr};
+    Ort::RunOptions runOptions{nullptr};
+    BatchBinding singleBinding;  // detect: plain frames, motion regions, warm-up
+    BatchBinding batchedBinding; // detectBatch: the current tile count
+    BatchBinding* activeBinding = nullptr;
+    int batchCapacity = 0;
+    std::vector<float> inputTensorValues;
+    std::vector<uint16_t> inputTensorFp16;
+    std::vector<uint8_t> inputTensorQuant;  // uint8 or int8 bit patterns
+    std::vector<uint8_t> outputRaw;         // bound output when it is not float32
+    std::vector<float> outputValues;        // float32 output, decoded by YoloDecoder
+    size_t bufferAllocations = 0;
+
+    // Pre/post-processing scratch, reused across frames
+    LetterboxPreprocessor preprocessor;
+    YoloDecoder decoder;
+    std::vector<LetterboxTransform> letterboxes;
+
+    Ort::SessionOptions buildSessionOptions() const;
+    std::string optimizedModelPath(const std::string& path);
+    std::unique_ptr<Ort::Session> createSession(const std::string& path);
+    void resolveMetadata();
+    void resolveQuantization();
+    void dequantizeOutput();
+    void bindBuffers();
+    void resolveOutputShape();
+    void reserveBatch(int batch);
+    void buildBinding(BatchBinding& slot, int batch);
+    void bindBatch(int batch);
+    LetterboxTransform preprocess(const cv::Mat& input, int slot);
+    void run();
+    void releaseBindings();
 };
@@ -0,0 +1,126 @@
+#include "YoloDecoder.h"
+#include "../../utils/profiler.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+// Column-wise running max/argmax of one class row over an anchor block.
+void updateMaxArg(const float* row, int cls, int n, float* maxv, int* argv) {
+    int i = 0;
+#if CV_SIMD128
+    const v_int32x4 vcls = v_setall_s32(cls);
+    for (; i <= n - 4; i += 4) {
+        v_float32x4 s = v_load(row + i);
+        v_float32x4 m = v_load(maxv + i);
+        v_int32x4 greater = v_reinterpret_as_s32(s > m);
+        v_store(maxv + i, v_max(s, m));
+        v_store(argv + i, v_select(greater, vcls, v_load(argv + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (row[i] > maxv[i]) {
+            maxv[i] = row[i];
+            argv[i] = cls;
+        }
+    }
+}
+
+} // namespace
+
+void YoloDecoder::decode(const float* data, int channels, int anchors, const LetterboxTransform& letterbox,
+                         float confThreshold, float iouThreshold, const vector<int>& allowedClasses,
+                         const vector<string>& classNames, const NmsConfig& nmsConfig, vector<YoloResult>& results) {
+    const int numClasses = channels - 4;
+    if (!data || numClasses <= 0 || anchors <= 0) return;
+
+    compileClassFilter(allowedClasses, numClasses);
+    collectCandidates(data, channels, anchors, letterbox, confThreshold);
+    suppress(iouThreshold, classNames, nmsConfig, results);
+}
+
+void YoloDecoder::compileClassFilter(const vector<int>& allowedClasses, int numClasses) {
+    // The filter only changes when the user edits it; skip the rebuild otherwise
+    if (numClasses == compiledNumClasses && allowedClasses == compiledFrom) return;
+    compiledFrom = allowedClasses;
+    compiledNumClasses = numClasses;
+
+    vector<uint8_t> enabled(numClasses, allowedClasses.empty() ? 1 : 0);
+    for (int cls : allowedClasses) {
+        if (cls >= 0 && cls < numClasses) enabled[cls] = 1;
+    }
+    // Ascending ids keep class rows read in memory order
+    activeClasses.clear();
+    for (int cls = 0; cls < numClasses; ++cls) {
+        if (enabled[cls]) activeClasses.push_back(cls);
+    }
+}
+
+void YoloDecoder::collectCandidates(const float* data, int channels, int anchors, const LetterboxTransform& letterbox,
+                                    float confThreshold) {
+    PROFILE_STAGE(Stage::Decode);
+    blockMax.resize(kAnchorBlock);
+    blockArg.resize(kAnchorBlock);
+    candidates.clear();
+
+    const float* cxRow = data;
+    const float* cyRow = data + anchors;
+    const float* wRow = data + 2 * (size_t)anchors;
+    const float* hRow = data + 3 * (size_t)anchors;
+    const float* scores = data + 4 * (size_t)anchors;
+
+    if (activeClasses.empty()) return; // filter matches no class of this model
+    const int firstClass = activeClasses[0];
+
+    for (int base = 0; base < anchors; base += kAnchorBlock) {
+        const int n = min(kAnchorBlock, anchors - base);
+        float* maxv = blockMax.data();
+        int* argv = blockArg.data();
+
+        // Only enabled class rows are scored: filtering to one class reads one row
+        const float* firstRow = scores + (size_t)firstClass * anchors + base;
+        copy(firstRow, firstRow + n, maxv);
+        fill(argv, argv + n, firstClass);
+        for (size_t k = 1; k < activeClasses.size(); ++k) {
+            const int cls = activeClasses[k];
+            updateMaxArg(scores + (size_t)cls * anchors + base, cls, n, maxv, argv);
+        }
+
+        for (int i = 0; i < n; ++i) {
+            if (maxv[i] <= confThreshold) continue;
+
+            const int a = base + i;
+            float w = wRow[a];
+            float h = hRow[a];
+            candidates.push(letterbox.toSourceX(cxRow[a] - 0.5f * w),
+                            letterbox.toSourceY(cyRow[a] - 0.5f * h),
+                            letterbox.toSourceLength(w),
+                            letterbox.toSourceLength(h),
+                            maxv[i], argv[i]);
+        }
+    }
+}
+
+void YoloDecoder::suppress(float iouThreshold, const vector<string>& classNames, const NmsConfig& nmsConfig,
+                           vector<YoloResult>& results) {
+    // Candidates are already above the confidence threshold
+    nms.run(candidates, iouThreshold, nmsConfig, nmsIndices);
+
+    for (int idx : nmsIndices) {
+        YoloResult res;
+        int clsId = candidates.classId[idx];
+        if (clsId >= 0 && clsId < (int)classNames.size()) res.label = classNames[clsId];
+        else res.label = "unknown";
+
+        res.confidence = candidates.score[idx];
+        res.x = candidates.left[idx];
+        res.y = candidates.top[idx];
+        res.width = candidates.width[idx];
+        res.height = candidates.height[idx];
+        res.classId = clsId;
+        results.push_back(res);
+    }
+}
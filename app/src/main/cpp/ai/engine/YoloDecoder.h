@@ -0,0 +1,39 @@
+#pragma once
+#include "../types.h"
+#include "Letterbox.h"
+#include "Nms.h"
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+// Shared YOLOv8-style output decoder for the [1, 4+nc, anchors] channel-major
+// layout, used by every engine. Scores are scanned row by row in anchor
+// blocks, so class rows are read contiguously and box data is only touched
+// for anchors that pass the confidence threshold.
+class YoloDecoder {
+public:
+    void decode(const float* data, int channels, int anchors, const LetterboxTransform& letterbox,
+                float confThreshold, float iouThreshold, const std::vector<int>& allowedClasses,
+                const std::vector<std::string>& classNames, const NmsConfig& nmsConfig,
+                std::vector<YoloResult>& results);
+
+private:
+    void compileClassFilter(const std::vector<int>& allowedClasses, int numClasses);
+    void collectCandidates(const float* data, int channels, int anchors, const LetterboxTransform& letterbox,
+                           float confThreshold);
+    void suppress(float iouThreshold, const std::vector<std::string>& classNames, const NmsConfig& nmsConfig,
+                  std::vector<YoloResult>& results);
+
+    static constexpr int kAnchorBlock = 256;
+
+    std::vector<float> blockMax;
+    std::vector<int> blockArg;
+    // Compiled class filter: ids of the class rows to score, rebuilt only when
+    // the filter or the model's class count changes
+    std::vector<int> activeClasses;
+    std::vector<int> compiledFrom;
+    int compiledNumClasses = -1;
+    DetectionCandidates candidates;
+    Nms nms;
+    std::vector<int> nmsIndices;
+};
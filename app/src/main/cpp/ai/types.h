@@ -1,13 +1,36 @@
 #pragma once
+#include <algorithm>
 #include <string>
 #include <vector>
 
 struct YoloResult {
     std::string label;
     float confidence;
-    int x;
-    int y;
-    int width;
-    int height;
+    float x; // box in source-frame pixels, sub-pixel precise
+    float y;
+    float width;
+    float height;
     int classId;
+    int trackId = -1; // stable id assigned by Tracker, -1 if untracked
 };
+
+// Fixed-layout binary record for passing results across JNI without JSON:
+// x, y, width, height, confidence, classId, trackId, all as native-order floats.
+constexpr int kPackedResultFloats = 7;
+
+// Writes up to `capacity` records into dst, returns the number written
+inline int packResults(const std::vector<YoloResult>& results, float* dst, int capacity) {
+    int count = std::min((int)results.size(), capacity);
+    for (int i = 0; i < count; ++i) {
+        const YoloResult& res = results[i];
+        float* rec = dst + i * kPackedResultFloats;
+        rec[0] = res.x;
+        rec[1] = res.y;
+        rec[2] = res.width;
+        rec[3] = res.height;
+        rec[4] = res.confidence;
+        rec[5] = (float)res.classId;
+        rec[6] = (float)res.trackId;
+    }
+    return count;
+}
@@ -0,0 +1,135 @@
+#include "FilterPipeline.h"
+#include "filters.h"
+#include "../utils/arena.h"
+#include "../utils/profiler.h"
+#include <opencv2/imgproc.hpp>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+FilterPipeline g_pipeline;
+mutex g_pipelineMutex;
+
+} // namespace
+
+bool filterOpFromName(const string& name, FilterOp& op) {
+    static const pair<const char*, FilterOp> kNames[] = {
+        {"Beauty", FilterOp::Beauty},
+        {"Dehaze", FilterOp::Dehaze},
+        {"Underwater", FilterOp::Underwater},
+        {"Stage", FilterOp::Stage},
+        {"Gray", FilterOp::Gray},
+        {"HistEq", FilterOp::HistEq},
+        {"Binary", FilterOp::Binary},
+        {"MorphOpen", FilterOp::MorphOpen},
+        {"MorphClose", FilterOp::MorphClose},
+        {"Blur", FilterOp::Blur},
+    };
+    for (const auto& entry : kNames) {
+        if (name == entry.first) {
+            op = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FilterPipeline::setOps(const vector<FilterOp>& ops) {
+    opList = ops;
+    plan.clear();
+
+    // Walk the chain tracking the current space; ops that work in any space
+    // (vignette, morphology, blur) stay wherever the previous op left the data.
+    Space current = Space::RGBA;
+    for (FilterOp op : ops) {
+        Space space;
+        switch (op) {
+            case FilterOp::Gray:
+            case FilterOp::Binary:
+                space = Space::Gray;
+                break;
+            case FilterOp::Stage:
+            case FilterOp::MorphOpen:
+            case FilterOp::MorphClose:
+            case FilterOp::Blur:
+                space = current;
+                break;
+            default:
+                space = Space::BGR;
+                break;
+        }
+        plan.push_back({op, space});
+        current = space;
+    }
+}
+
+Mat& FilterPipeline::buffer(Space space, Mat& frame) {
+    switch (space) {
+        case Space::BGR: return bgr;
+        case Space::Gray: return gray;
+        default: return frame;
+    }
+}
+
+void FilterPipeline::convert(Mat& frame, Space from, Space to) {
+    if (from == to) return;
+    static const int kCodes[3][3] = {
+        // to:     RGBA                BGR                 Gray
+        /* RGBA */ {-1,                COLOR_RGBA2BGR,     COLOR_RGBA2GRAY},
+        /* BGR  */ {COLOR_BGR2RGBA,    -1,                 COLOR_BGR2GRAY},
+        /* Gray */ {COLOR_GRAY2RGBA,   COLOR_GRAY2BGR,     -1},
+    };
+    // Destination buffers keep their size and type, so cvtColor reuses them
+    cvtColor(buffer(from, frame), buffer(to, frame), kCodes[(int)from][(int)to]);
+}
+
+void FilterPipeline::run(FilterOp op, Mat& data) {
+    switch (op) {
+        case FilterOp::Beauty: beautyBGR(data, beautyStrength); break;
+        case FilterOp::Dehaze: dehazeBGR(data); break;
+        case FilterOp::Underwater: underwaterBGR(data); break;
+        case FilterOp::Stage: stageVignette(data, kDefaultStageRadius, kDefaultStageFalloff); break;
+        case FilterOp::HistEq: histEqBGR(data); break;
+        case FilterOp::Binary: binaryGray(data); break;
+        case FilterOp::Gray: break; // the conversion into Gray is the whole op
+        case FilterOp::MorphOpen:
+        case FilterOp::MorphClose:
+            if (morphKernel.empty()) morphKernel = getStructuringElement(MORPH_RECT, Size(5, 5));
+            morphologyEx(data, data, op == FilterOp::MorphOpen ? MORPH_OPEN : MORPH_CLOSE, morphKernel);
+            break;
+        case FilterOp::Blur:
+            GaussianBlur(data, data, Size(15, 15), 0);
+            break;
+    }
+}
+
+void FilterPipeline::apply(Mat& frame) {
+    if (frame.empty() || plan.empty() || frame.type() != CV_8UC4) return;
+    PROFILE_STAGE(Stage::Filters);
+    FrameScope scope; // the whole chain is one arena frame
+
+    Space current = Space::RGBA;
+    for (const auto& step : plan) {
+        convert(frame, current, step.space);
+        current = step.space;
+        run(step.op, buffer(current, frame));
+    }
+    convert(frame, current, Space::RGBA);
+}
+
+void setFilterChain(const vector<FilterOp>& ops) {
+    lock_guard<mutex> lock(g_pipelineMutex);
+    if (ops != g_pipeline.ops()) g_pipeline.setOps(ops);
+}
+
+void setFilterChainBeautyStrength(float strength) {
+    lock_guard<mutex> lock(g_pipelineMutex);
+    g_pipeline.setBeautyStrength(strength);
+}
+
+void applyFilterChain(Mat& frame) {
+    lock_guard<mutex> lock(g_pipelineMutex);
+    g_pipeline.apply(frame);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "filters.h"
+#include <opencv2/core.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class FilterOp {
+    Beauty,
+    Dehaze,
+    Underwater,
+    Stage,
+    Gray,
+    HistEq,
+    Binary,
+    MorphOpen,
+    MorphClose,
+    Blur,
+};
+
+// Maps the UI filter names ("Beauty", "Dehaze", ...) to ops.
+bool filterOpFromName(const std::string& name, FilterOp& op);
+
+// Runs an ordered chain of filters on an RGBA frame. Colour-space transitions
+// are planned once in setOps, so a chain converts RGBA -> working space once,
+// runs every op on reusable scratch buffers, and converts back once.
+class FilterPipeline {
+public:
+    void setOps(const std::vector<FilterOp>& ops);
+    const std::vector<FilterOp>& ops() const { return opList; }
+    void setBeautyStrength(float strength) { beautyStrength = strength; }
+    void apply(cv::Mat& frame);
+
+private:
+    enum class Space { RGBA, BGR, Gray };
+
+    struct Step {
+        FilterOp op;
+        Space space; // space the op runs in; the frame is converted to it first
+    };
+
+    cv::Mat& buffer(Space space, cv::Mat& frame);
+    void convert(cv::Mat& frame, Space from, Space to);
+    void run(FilterOp op, cv::Mat& data);
+
+    std::vector<FilterOp> opList;
+    std::vector<Step> plan;
+    float beautyStrength = kDefaultBeautyStrength;
+
+    cv::Mat bgr;
+    cv::Mat gray;
+    cv::Mat morphKernel;
+};
+
+// C-style wrappers for JNI: a process-wide chain set only when it changes
+void setFilterChain(const std::vector<FilterOp>& ops);
+void setFilterChainBeautyStrength(float strength);
+void applyFilterChain(cv::Mat& frame);
@@ -0,0 +1,192 @@
+#include "TemporalLut.h"
+#include "../utils/threadpool.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+// Bilinear lookup of one pixel value in the four surrounding tile tables
+inline float blendLut(const float* top, const float* bottom, int left, int right, float wx, float wy, int v) {
+    float t = top[left + v] + (top[right + v] - top[left + v]) * wx;
+    float b = bottom[left + v] + (bottom[right + v] - bottom[left + v]) * wx;
+    return t + (b - t) * wy;
+}
+
+} // namespace
+
+TemporalLut::TemporalLut(int tilesX, int tilesY, float clipLimit, int outLow, int outHigh)
+    : tilesX(max(1, tilesX)), tilesY(max(1, tilesY)), clipLimit(clipLimit), outLow(outLow), outHigh(outHigh) {}
+
+void TemporalLut::setConfig(const TemporalLutConfig& newConfig) {
+    config = newConfig;
+    reset();
+}
+
+void TemporalLut::reset() {
+    primed = false;
+    framesUntilUpdate = 0;
+}
+
+void TemporalLut::tileLut(const Mat& src, const Rect& tile, float* lut) const {
+    const int step = max(1, config.sampleStep);
+    int hist[256] = {};
+    int count = 0;
+    for (int y = tile.y; y < tile.y + tile.height; y += step) {
+        const uchar* row = src.ptr<uchar>(y);
+        for (int x = tile.x; x < tile.x + tile.width; x += step) hist[row[x]]++;
+        count += (tile.width + step - 1) / step;
+    }
+    const float range = (float)(outHigh - outLow);
+    if (count == 0) {
+        for (int v = 0; v < 256; ++v) lut[v] = outLow + v * range / 255.0f;
+        return;
+    }
+
+    if (clipLimit > 0) {
+        // CLAHE: clip the histogram, spread the excess evenly, map through the CDF
+        const int limit = max(1, (int)(clipLimit * count / 256));
+        int clipped = 0;
+        for (int v = 0; v < 256; ++v) {
+            if (hist[v] > limit) {
+                clipped += hist[v] - limit;
+                hist[v] = limit;
+            }
+        }
+        const int batch = clipped / 256;
+        int residual = clipped - batch * 256;
+        const int residualStep = max(256 / max(residual, 1), 1);
+        for (int v = 0; v < 256; ++v) hist[v] += batch;
+        for (int v = 0; v < 256 && residual > 0; v += residualStep, --residual) hist[v]++;
+
+        const float scale = range / count;
+        int sum = 0;
+        for (int v = 0; v < 256; ++v) {
+            sum += hist[v];
+            lut[v] = outLow + sum * scale;
+        }
+        return;
+    }
+
+    // Plain equalization with equalizeHist's mapping (first occupied bin -> outLow)
+    int first = 0;
+    while (first < 255 && hist[first] == 0) ++first;
+    if (hist[first] == count) {
+        for (int v = 0; v < 256; ++v) lut[v] = (float)v;
+        return;
+    }
+    const float scale = range / (count - hist[first]);
+    int sum = 0;
+    for (int v = 0; v <= first; ++v) lut[v] = (float)outLow;
+    for (int v = first + 1; v < 256; ++v) {
+        sum += hist[v];
+        lut[v] = outLow + sum * scale;
+    }
+}
+
+void TemporalLut::update(const Mat& src) {
+    const int tiles = tilesX * tilesY;
+    fresh.resize((size_t)tiles * 256);
+    for (int ty = 0; ty < tilesY; ++ty) {
+        const int y0 = ty * src.rows / tilesY, y1 = (ty + 1) * src.rows / tilesY;
+        for (int tx = 0; tx < tilesX; ++tx) {
+            const int x0 = tx * src.cols / tilesX, x1 = (tx + 1) * src.cols / tilesX;
+            tileLut(src, Rect(x0, y0, x1 - x0, y1 - y0), &fresh[(size_t)(ty * tilesX + tx) * 256]);
+        }
+    }
+
+    // Exponential smoothing; the first frame (or a new size) starts from its own LUTs
+    if (!primed || luts.size() != fresh.size()) {
+        luts = fresh;
+    } else {
+        const float a = min(max(config.smoothing, 0.0f), 1.0f);
+        for (size_t i = 0; i < luts.size(); ++i) luts[i] += (fresh[i] - luts[i]) * a;
+    }
+    primed = true;
+
+    if (tiles == 1) {
+        globalLut.create(1, 256, CV_8U);
+        for (int v = 0; v < 256; ++v) globalLut.at<uchar>(v) = saturate_cast<uchar>(luts[v]);
+    }
+}
+
+void TemporalLut::interpolate(const Mat& src, Mat& dst) const {
+    const float tileH = (float)src.rows / tilesY;
+    const int width = src.cols;
+    const float* tables = luts.data();
+
+    parallelRowBands(src.rows, [&](int begin, int end) {
+        for (int y = begin; y < end; ++y) {
+            // Pixel centers between tile centers blend the two nearest tile rows
+            const float fy = (y + 0.5f) / tileH - 0.5f;
+            int ty1 = (int)floor(fy);
+            const float wy = fy - ty1;
+            int ty2 = min(ty1 + 1, tilesY - 1);
+            ty1 = max(ty1, 0);
+            const float* top = tables + (size_t)ty1 * tilesX * 256;
+            const float* bottom = tables + (size_t)ty2 * tilesX * 256;
+
+            const uchar* in = src.ptr<uchar>(y);
+            uchar* out = dst.ptr<uchar>(y);
+            int x = 0;
+#if CV_SIMD128
+            const v_float32x4 vwy = v_setall_f32(wy);
+            for (; x <= width - 16; x += 16) {
+                v_uint16x8 lo16, hi16;
+                v_expand(v_load(in + x), lo16, hi16);
+                v_uint32x4 px[4];
+                v_expand(lo16, px[0], px[1]);
+                v_expand(hi16, px[2], px[3]);
+                v_int32x4 res[4];
+                for (int k = 0; k < 4; ++k) {
+                    const int xk = x + 4 * k;
+                    const v_int32x4 v = v_reinterpret_as_s32(px[k]);
+                    const v_int32x4 left = v_load(colLeft.data() + xk) + v;
+                    const v_int32x4 right = v_load(colRight.data() + xk) + v;
+                    const v_float32x4 wx = v_load(colWeight.data() + xk);
+                    v_float32x4 tl = v_lut(top, left), tr = v_lut(top, right);
+                    v_float32x4 bl = v_lut(bottom, left), br = v_lut(bottom, right);
+                    v_float32x4 t = v_muladd(tr - tl, wx, tl);
+                    v_float32x4 b = v_muladd(br - bl, wx, bl);
+                    res[k] = v_round(v_muladd(b - t, vwy, t));
+                }
+                v_store(out + x, v_pack_u(v_pack(res[0], res[1]), v_pack(res[2], res[3])));
+            }
+#endif
+            for (; x < width; ++x) {
+                out[x] = saturate_cast<uchar>(blendLut(top, bottom, colLeft[x], colRight[x], colWeight[x], wy, in[x]));
+            }
+        }
+    });
+}
+
+void TemporalLut::apply(const Mat& src, Mat& dst) {
+    CV_Assert(src.type() == CV_8UC1);
+    if (src.size() != size) {
+        size = src.size();
+        reset();
+        const float tileW = (float)size.width / tilesX;
+        colLeft.resize(size.width);
+        colRight.resize(size.width);
+        colWeight.resize(size.width);
+        for (int x = 0; x < size.width; ++x) {
+            const float fx = (x + 0.5f) / tileW - 0.5f;
+            const int tx = (int)floor(fx);
+            colWeight[x] = fx - tx;
+            colLeft[x] = max(tx, 0) * 256;
+            colRight[x] = min(tx + 1, tilesX - 1) * 256;
+        }
+    }
+
+    if (framesUntilUpdate-- <= 0) {
+        update(src);
+        framesUntilUpdate = max(1, config.updateInterval) - 1;
+    }
+
+    dst.create(src.size(), CV_8UC1);
+    if (tilesX * tilesY == 1) LUT(src, globalLut, dst);
+    else interpolate(src, dst);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+
+struct TemporalLutConfig {
+    int updateInterval = 4;  // recompute histograms every N frames
+    float smoothing = 0.25f; // weight of a fresh LUT in the running average (1 = none)
+    int sampleStep = 4;      // histograms read every Nth row and column
+};
+
+// Tone mapping for video: histogram equalization (one tile, no clipping) or
+// CLAHE (a grid of tiles with a clip limit) whose LUTs persist across
+// frames. Histograms come from a subsampled grid every few frames and are
+// blended into the previous LUTs, so tones no longer flicker frame to frame
+// and most frames only pay for the lookup itself.
+class TemporalLut {
+public:
+    TemporalLut(int tilesX, int tilesY, float clipLimit, int outLow = 0, int outHigh = 255);
+
+    void setConfig(const TemporalLutConfig& config);
+    // Forget the LUTs; the next frame is equalized from scratch
+    void reset();
+    // 8-bit single channel; dst may be src
+    void apply(const cv::Mat& src, cv::Mat& dst);
+
+private:
+    void update(const cv::Mat& src);
+    void tileLut(const cv::Mat& src, const cv::Rect& tile, float* lut) const;
+    void interpolate(const cv::Mat& src, cv::Mat& dst) const;
+
+    int tilesX;
+    int tilesY;
+    float clipLimit;
+    int outLow;
+    int outHigh;
+    TemporalLutConfig config;
+
+    cv::Size size;
+    int framesUntilUpdate = 0;
+    bool primed = false;
+    std::vector<float> luts;  // tilesX * tilesY tables of 256 entries, smoothed
+    std::vector<float> fresh; // LUTs from the latest histograms
+    cv::Mat globalLut;        // rounded table for the single-tile case
+
+    // Per-column bilinear terms: offsets of the left/right tile tables and the right weight
+    std::vector<int> colLeft;
+    std::vector<int> colRight;
+    std::vector<float> colWeight;
+};
@@ -1,98 +1,453 @@
 #include "filters.h"
+#include "../utils/arena.h"
+#include "../utils/profiler.h"
+#include "../utils/threadpool.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
 #include <vector>
 
 using namespace cv;
 using namespace std;
 
-void applyBeauty(Mat& src) {
+namespace {
+
+// Runs a BGR kernel on an RGBA (or BGR) frame in place; one arena frame.
+// Other channel counts (e.g. gray) have no colour to work on and pass through.
+template <typename Kernel>
+void applyOnBGR(Mat& src, Kernel kernel) {
     if (src.empty()) return;
-    Mat bgr;
-    if (src.channels() == 4) cvtColor(src, bgr, COLOR_RGBA2BGR);
-    else bgr = src.clone();
+    FrameScope frame;
+    if (src.channels() == 4) {
+        Mat& bgr = FrameArena::local().acquire(src.size(), CV_8UC3);
+        cvtColor(src, bgr, COLOR_RGBA2BGR);
+        kernel(bgr);
+        cvtColor(bgr, src, COLOR_BGR2RGBA);
+    } else if (src.channels() == 3) {
+        kernel(src);
+    }
+}
+
+} // namespace
+
+// Edge-preserving beauty filter built on the fast guided filter:
+// self-guided smoothing coefficients are computed at reduced resolution with
+// O(1) box filters, then applied to the full-resolution frame, so edges follow
+// the full-res guide. Smoothing is restricted to a soft skin mask; non-skin
+// pixels get an unsharp mask (original minus its guided low-pass) instead.
+void beautyBGR(Mat& bgr, float strength) {
+    strength = std::min(1.0f, std::max(0.0f, strength));
+    if (bgr.empty() || strength <= 0.0f) return;
+
+    const int factor = std::max(1, std::min(bgr.rows, bgr.cols) / 270);
+    const int radius = 3;
+    const float eps = 20.0f * 20.0f; // in 8-bit intensity units
+    const float sharpAmount = 0.5f * strength;
+
+    // All temporaries come from the frame arena: written in place every
+    // frame, allocated only when the resolution changes
+    FrameScope frame;
+    FrameArena& arena = FrameArena::local();
+    const Size smallSize(bgr.cols / factor, bgr.rows / factor);
+    Mat& small = arena.acquire(smallSize, CV_8UC3);
+    resize(bgr, small, smallSize, 0, 0, INTER_AREA);
+
+    // Soft skin probability from the classic YCrCb box
+    Mat& ycrcb = arena.acquire(smallSize, CV_8UC3);
+    Mat& skin = arena.acquire(smallSize, CV_8UC1);
+    Mat& skinF = arena.acquire(smallSize, CV_32FC1);
+    cvtColor(small, ycrcb, COLOR_BGR2YCrCb);
+    inRange(ycrcb, Scalar(0, 133, 77), Scalar(255, 173, 127), skin);
+    skin.convertTo(skinF, CV_32F, 1.0 / 255.0);
+    GaussianBlur(skinF, skinF, Size(0, 0), 2.0);
+
+    // Self-guided filter coefficients: a = var / (var + eps), b = mean * (1 - a)
+    Mat& I = arena.acquire(smallSize, CV_32FC3);
+    Mat& meanI = arena.acquire(smallSize, CV_32FC3);
+    Mat& corrI = arena.acquire(smallSize, CV_32FC3);
+    Mat& varI = arena.acquire(smallSize, CV_32FC3);
+    Mat& tmp = arena.acquire(smallSize, CV_32FC3);
+    Mat& a = arena.acquire(smallSize, CV_32FC3);
+    Mat& b = arena.acquire(smallSize, CV_32FC3);
+    small.convertTo(I, CV_32F);
+    const Size box(2 * radius + 1, 2 * radius + 1);
+    boxFilter(I, meanI, CV_32F, box);
+    multiply(I, I, tmp);
+    boxFilter(tmp, corrI, CV_32F, box);
+    multiply(meanI, meanI, tmp);
+    subtract(corrI, tmp, varI);
+    add(varI, Scalar::all(eps), tmp);
+    divide(varI, tmp, a);
+    multiply(a, meanI, tmp);
+    subtract(meanI, tmp, b);
+    boxFilter(a, a, CV_32F, box);
+    boxFilter(b, b, CV_32F, box);
+
+    // Per-pixel blend weight: +strength pulls skin toward the smoothed base,
+    // negative weight pushes non-skin away from it (unsharp mask)
+    Mat& weight = arena.acquire(smallSize, CV_32FC1);
+    skinF.convertTo(weight, CV_32F, strength + sharpAmount, -sharpAmount);
+
+    Mat& coeffs = arena.acquire(smallSize, CV_32FC(7)); // a(3), b(3), weight(1)
+    Mat planes[] = {a, b, weight};
+    merge(planes, 3, coeffs);
+
+    const int ws = coeffs.cols, hs = coeffs.rows;
+    const float sx = (float)ws / bgr.cols, sy = (float)hs / bgr.rows;
+    int* x0 = arena.acquire(1, bgr.cols, CV_32SC1).ptr<int>();
+    int* x1 = arena.acquire(1, bgr.cols, CV_32SC1).ptr<int>();
+    float* wx = arena.acquire(1, bgr.cols, CV_32FC1).ptr<float>();
+    for (int x = 0; x < bgr.cols; ++x) {
+        float fx = std::max(0.0f, (x + 0.5f) * sx - 0.5f);
+        x0[x] = std::min((int)fx, ws - 1);
+        x1[x] = std::min(x0[x] + 1, ws - 1);
+        wx[x] = fx - x0[x];
+    }
+
+    // Fused bilinear upsampling of the coefficients + guided output + blend
+    parallelRowBands(bgr.rows, [&](int begin, int end) {
+        // Pool workers have no frame scope of their own, so their row scratch
+        // is a per-thread buffer that only grows
+        thread_local vector<float> rowCoeffs;
+        if (rowCoeffs.size() < (size_t)ws * 7) rowCoeffs.resize((size_t)ws * 7);
+        for (int y = begin; y < end; ++y) {
+            float fy = std::max(0.0f, (y + 0.5f) * sy - 0.5f);
+            int y0 = std::min((int)fy, hs - 1), y1 = std::min(y0 + 1, hs - 1);
+            float wy = fy - y0;
+            const float* top = coeffs.ptr<float>(y0);
+            const float* bottom = coeffs.ptr<float>(y1);
+            for (int i = 0; i < ws * 7; ++i) rowCoeffs[i] = top[i] + (bottom[i] - top[i]) * wy;
+
+            uchar* px = bgr.ptr<uchar>(y);
+            for (int x = 0; x < bgr.cols; ++x, px += 3) {
+                const float* c0 = &rowCoeffs[x0[x] * 7];
+                const float* c1 = &rowCoeffs[x1[x] * 7];
+                float c[7];
+                for (int k = 0; k < 7; ++k) c[k] = c0[k] + (c1[k] - c0[k]) * wx[x];
+                for (int ch = 0; ch < 3; ++ch) {
+                    float in = px[ch];
+                    float base = c[ch] * in + c[3 + ch];
+                    px[ch] = saturate_cast<uchar>(in + c[6] * (base - in));
+                }
+            }
+        }
+    });
+}
+
+namespace {
+
+constexpr float kDehazeClipLimit = 2.0f;
+constexpr int kDehazeTiles = 8; // createCLAHE's default grid
+
+atomic<bool> g_videoMode{false};
+atomic<int> g_videoGeneration{0};
+mutex g_videoMutex;
+TemporalLutConfig g_videoConfig; // guarded by g_videoMutex
 
-    Mat smoothed;
-    bilateralFilter(bgr, smoothed, 9, 75, 75);
-    Mat sharpened;
-    addWeighted(smoothed, 1.5, smoothed, -0.5, 0, sharpened);
+// Tone LUTs of one filter on one thread, re-synced when the video config changes
+struct VideoLut {
+    TemporalLut lut;
+    int generation = -1;
 
-    if (src.channels() == 4) cvtColor(sharpened, src, COLOR_BGR2RGBA);
-    else sharpened.copyTo(src);
+    VideoLut(int tiles, float clipLimit, int outLow = 0, int outHigh = 255)
+        : lut(tiles, tiles, clipLimit, outLow, outHigh) {}
+
+    void apply(const Mat& src, Mat& dst) {
+        const int current = g_videoGeneration;
+        if (current != generation) {
+            lock_guard<mutex> lock(g_videoMutex);
+            lut.setConfig(g_videoConfig);
+            generation = current;
+        }
+        lut.apply(src, dst);
+    }
+};
+
+thread_local VideoLut t_dehazeLut(kDehazeTiles, kDehazeClipLimit);
+thread_local VideoLut t_histEqLut(1, 0.0f);
+thread_local VideoLut t_dehazeLumaLut(kDehazeTiles, kDehazeClipLimit);
+thread_local VideoLut t_histEqLumaLut(1, 0.0f, 16, 235);
+
+// Still-image CLAHE, created once per thread instead of once per frame
+CLAHE& stillClahe() {
+    static thread_local Ptr<CLAHE> clahe = createCLAHE(kDehazeClipLimit, Size(kDehazeTiles, kDehazeTiles));
+    return *clahe;
+}
+
+} // namespace
+
+void setFilterVideoMode(bool enabled, const TemporalLutConfig& config) {
+    {
+        lock_guard<mutex> lock(g_videoMutex);
+        g_videoConfig = config;
+    }
+    ++g_videoGeneration; // every thread starts over with the new settings
+    g_videoMode = enabled;
+}
+
+void dehazeBGR(Mat& bgr) {
+    FrameScope frame;
+    Mat& lab = FrameArena::local().acquire(bgr.size(), CV_8UC3);
+    Mat& lightness = FrameArena::local().acquire(bgr.size(), CV_8UC1);
+    cvtColor(bgr, lab, COLOR_BGR2Lab);
+    // Only L changes: extract and reinsert it rather than splitting all planes
+    extractChannel(lab, lightness, 0);
+    if (g_videoMode) t_dehazeLut.apply(lightness, lightness);
+    else stillClahe().apply(lightness, lightness);
+    insertChannel(lightness, lab, 0);
+    cvtColor(lab, bgr, COLOR_Lab2BGR);
+}
+
+namespace {
+
+// Video range -> full range, the gray value RGB conversion would produce
+const Mat& fullRangeLut() {
+    static const Mat lut = [] {
+        Mat table(1, 256, CV_8U);
+        for (int v = 0; v < 256; ++v) table.at<uchar>(v) = saturate_cast<uchar>((v - 16) * 255.0 / 219.0);
+        return table;
+    }();
+    return lut;
+}
+
+} // namespace
+
+void grayFromLuma(const Mat& y, Mat& dst) {
+    LUT(y, fullRangeLut(), dst);
+}
+
+void binaryFromLuma(const Mat& y, Mat& dst) {
+    // Threshold of binaryGray moved onto the video-range values
+    static const Mat lut = [] {
+        Mat table(1, 256, CV_8U);
+        const uchar* full = fullRangeLut().ptr<uchar>();
+        for (int v = 0; v < 256; ++v) table.at<uchar>(v) = full[v] > 128 ? 255 : 0;
+        return table;
+    }();
+    LUT(y, lut, dst);
+}
+
+void equalizeLuma(const Mat& y, Mat& dst) {
+    if (g_videoMode) {
+        t_histEqLumaLut.apply(y, dst);
+        return;
+    }
+    // equalizeHist's mapping, rescaled into video range so the RGB
+    // conversion sees the same tones histEqBGR would produce
+    int hist[256] = {};
+    for (int r = 0; r < y.rows; ++r) {
+        const uchar* row = y.ptr<uchar>(r);
+        for (int c = 0; c < y.cols; ++c) hist[row[c]]++;
+    }
+    const int total = y.rows * y.cols;
+    int first = 0;
+    while (first < 255 && hist[first] == 0) ++first;
+
+    Mat lut(1, 256, CV_8U, Scalar(16));
+    uchar* table = lut.ptr<uchar>();
+    if (hist[first] == total) {
+        table[first] = (uchar)first; // flat image: keep it as is
+    } else {
+        const float scale = 219.0f / (total - hist[first]);
+        int sum = 0;
+        for (int v = first + 1; v < 256; ++v) {
+            sum += hist[v];
+            table[v] = saturate_cast<uchar>(16 + sum * scale);
+        }
+    }
+    LUT(y, lut, dst);
+}
+
+void dehazeLuma(const Mat& y, Mat& dst) {
+    // Same CLAHE as dehazeBGR, with camera luma standing in for Lab L
+    if (g_videoMode) t_dehazeLumaLut.apply(y, dst);
+    else stillClahe().apply(y, dst);
+}
+
+void underwaterBGR(Mat& bgr) {
+    add(bgr, Scalar(0, 0, 40), bgr);
+}
+
+namespace {
+
+// Q8 vignette gain map (255 = unity), rebuilt only when the frame size or
+// parameters change.
+struct VignetteCache {
+    Size size;
+    float radius = -1;
+    float falloff = -1;
+    Mat gain;
+
+    const Mat& get(Size frameSize, float r, float f) {
+        if (frameSize == size && r == radius && f == falloff) return gain;
+        size = frameSize;
+        radius = r;
+        falloff = f;
+        gain.create(frameSize, CV_8U);
+
+        const float norm = 1.0f / std::min(frameSize.width, frameSize.height);
+        const float cx = 0.5f * (frameSize.width - 1), cy = 0.5f * (frameSize.height - 1);
+        const float inner = std::max(0.0f, r - 0.5f * f), outer = r + 0.5f * f;
+        for (int y = 0; y < frameSize.height; ++y) {
+            uchar* row = gain.ptr<uchar>(y);
+            float dy = (y - cy) * norm;
+            for (int x = 0; x < frameSize.width; ++x) {
+                float dx = (x - cx) * norm;
+                float d = std::sqrt(dx * dx + dy * dy);
+                float t = outer > inner ? std::min(1.0f, std::max(0.0f, (d - inner) / (outer - inner))) : (d > r ? 1.0f : 0.0f);
+                float g = 1.0f - t * t * (3.0f - 2.0f * t); // smoothstep falloff
+                row[x] = saturate_cast<uchar>(g * 255.0f);
+            }
+        }
+        return gain;
+    }
+};
+
+thread_local VignetteCache t_vignette;
+
+// (v * g) / 255 with rounding, exact for g = 255
+inline uchar scaleQ8(uchar v, uchar g) {
+    unsigned t = v * g + 128;
+    return (uchar)((t + (t >> 8)) >> 8);
+}
+
+#if CV_SIMD128
+inline v_uint8x16 scaleQ8(const v_uint8x16& v, const v_uint8x16& g) {
+    v_uint16x8 lo, hi;
+    v_mul_expand(v, g, lo, hi);
+    const v_uint16x8 bias = v_setall_u16(128);
+    lo = lo + bias;
+    hi = hi + bias;
+    lo = v_shr<8>(lo + v_shr<8>(lo));
+    hi = v_shr<8>(hi + v_shr<8>(hi));
+    return v_pack(lo, hi);
+}
+#endif
+
+void vignetteRow(uchar* px, const uchar* gain, int width, int cn) {
+    int x = 0;
+#if CV_SIMD128
+    for (; x <= width - 16; x += 16) {
+        v_uint8x16 g = v_load(gain + x);
+        if (cn == 4) {
+            v_uint8x16 c0, c1, c2, c3;
+            v_load_deinterleave(px + x * 4, c0, c1, c2, c3);
+            v_store_interleave(px + x * 4, scaleQ8(c0, g), scaleQ8(c1, g), scaleQ8(c2, g), c3);
+        } else if (cn == 3) {
+            v_uint8x16 c0, c1, c2;
+            v_load_deinterleave(px + x * 3, c0, c1, c2);
+            v_store_interleave(px + x * 3, scaleQ8(c0, g), scaleQ8(c1, g), scaleQ8(c2, g));
+        } else {
+            v_store(px + x, scaleQ8(v_load(px + x), g));
+        }
+    }
+#endif
+    const int colorChannels = std::min(cn, 3);
+    for (; x < width; ++x) {
+        uchar* p = px + x * cn;
+        for (int c = 0; c < colorChannels; ++c) p[c] = scaleQ8(p[c], gain[x]);
+    }
+}
+
+} // namespace
+
+void stageVignette(Mat& img, float radius, float falloff) {
+    if (img.empty() || img.depth() != CV_8U) return;
+    const Mat& gain = t_vignette.get(img.size(), radius, falloff);
+    const int cn = img.channels();
+    parallelRowBands(img.rows, [&](int begin, int end) {
+        for (int y = begin; y < end; ++y) {
+            vignetteRow(img.ptr<uchar>(y), gain.ptr<uchar>(y), img.cols, cn);
+        }
+    });
+}
+
+void histEqBGR(Mat& bgr) {
+    FrameScope frame;
+    Mat& ycrcb = FrameArena::local().acquire(bgr.size(), CV_8UC3);
+    Mat& luma = FrameArena::local().acquire(bgr.size(), CV_8UC1);
+    cvtColor(bgr, ycrcb, COLOR_BGR2YCrCb);
+    extractChannel(ycrcb, luma, 0);
+    if (g_videoMode) t_histEqLut.apply(luma, luma);
+    else equalizeHist(luma, luma);
+    insertChannel(luma, ycrcb, 0);
+    cvtColor(ycrcb, bgr, COLOR_YCrCb2BGR);
+}
+
+void binaryGray(Mat& gray) {
+    threshold(gray, gray, 128, 255, THRESH_BINARY);
+}
+
+void applyBeauty(Mat& src) {
+    applyBeauty(src, kDefaultBeautyStrength);
+}
+
+void applyBeauty(Mat& src, float strength) {
+    PROFILE_STAGE(Stage::Filters);
+    applyOnBGR(src, [strength](Mat& bgr) { beautyBGR(bgr, strength); });
 }
 
 void applyDehaze(Mat& src) {
-    if (src.empty()) return;
-    Mat lab;
-    if (src.channels() == 4) cvtColor(src, lab, COLOR_RGBA2BGR); else lab = src.clone();
-    cvtColor(lab, lab, COLOR_BGR2Lab);
-    vector<Mat> lab_planes;
-    split(lab, lab_planes);
-    Ptr<CLAHE> clahe = createCLAHE();
-    clahe->setClipLimit(2.0);
-    clahe->apply(lab_planes[0], lab_planes[0]);
-    merge(lab_planes, lab);
-    Mat result;
-    cvtColor(lab, result, COLOR_Lab2BGR);
-    if (src.channels() == 4) cvtColor(result, src, COLOR_BGR2RGBA); else result.copyTo(src);
+    PROFILE_STAGE(Stage::Filters);
+    applyOnBGR(src, dehazeBGR);
 }
 
 void applyUnderwater(Mat& src) {
-    if (src.empty()) return;
-    Mat bgr;
-    if (src.channels() == 4) cvtColor(src, bgr, COLOR_RGBA2BGR); else bgr = src; 
-    vector<Mat> channels;
-    split(bgr, channels);
-    add(channels[2], Scalar(40), channels[2]); 
-    merge(channels, bgr);
-    if (src.channels() == 4) cvtColor(bgr, src, COLOR_BGR2RGBA);
+    PROFILE_STAGE(Stage::Filters);
+    applyOnBGR(src, underwaterBGR);
 }
 
 void applyStage(Mat& src) {
-    if (src.empty()) return;
-    Mat bgr;
-    if (src.channels() == 4) cvtColor(src, bgr, COLOR_RGBA2BGR); else bgr = src.clone();
-    int rows = bgr.rows, cols = bgr.cols;
-    Mat mask = Mat::zeros(rows, cols, CV_32F);
-    circle(mask, Point(cols/2, rows/2), min(rows, cols)/2, Scalar(1.0), -1);
-    GaussianBlur(mask, mask, Size(0,0), min(rows, cols)/4);
-    Mat bgrF; bgr.convertTo(bgrF, CV_32F);
-    vector<Mat> chans; split(bgrF, chans);
-    for(int i=0; i<3; i++) multiply(chans[i], mask, chans[i]);
-    merge(chans, bgrF);
-    bgrF.convertTo(bgr, CV_8U);
-    if (src.channels() == 4) cvtColor(bgr, src, COLOR_BGR2RGBA); else bgr.copyTo(src);
+    applyStage(src, kDefaultStageRadius, kDefaultStageFalloff);
+}
+
+void applyStage(Mat& src, float radius, float falloff) {
+    PROFILE_STAGE(Stage::Filters);
+    // Channel-agnostic gain, so RGBA is processed in place without conversion
+    stageVignette(src, radius, falloff);
 }
 
 void applyGray(Mat& src) {
-    if(src.channels()==4) cvtColor(src, src, COLOR_RGBA2GRAY);
-    else if(src.channels()==3) cvtColor(src, src, COLOR_BGR2GRAY);
-    cvtColor(src, src, COLOR_GRAY2RGBA); 
+    PROFILE_STAGE(Stage::Filters);
+    if (src.empty()) return;
+    // Through an arena plane: converting src in place would reallocate it twice
+    FrameScope frame;
+    Mat& gray = FrameArena::local().acquire(src.size(), CV_8UC1);
+    if(src.channels()==4) cvtColor(src, gray, COLOR_RGBA2GRAY);
+    else if(src.channels()==3) cvtColor(src, gray, COLOR_BGR2GRAY);
+    else src.copyTo(gray);
+    cvtColor(gray, src, COLOR_GRAY2RGBA);
 }
 
 void applyHistEq(Mat& src) {
-    Mat ycrcb;
-    if(src.channels()==4) cvtColor(src, src, COLOR_RGBA2BGR);
-    cvtColor(src, ycrcb, COLOR_BGR2YCrCb);
-    vector<Mat> c; split(ycrcb, c);
-    equalizeHist(c[0], c[0]);
-    merge(c, ycrcb);
-    cvtColor(ycrcb, src, COLOR_YCrCb2BGR);
-    cvtColor(src, src, COLOR_BGR2RGBA);
+    PROFILE_STAGE(Stage::Filters);
+    applyOnBGR(src, histEqBGR);
+    if (src.channels() == 3) cvtColor(src, src, COLOR_BGR2RGBA);
 }
 
 void applyBinary(Mat& src) {
-    Mat g; if(src.channels()==4) cvtColor(src, g, COLOR_RGBA2GRAY); else cvtColor(src, g, COLOR_BGR2GRAY);
-    threshold(g, g, 128, 255, THRESH_BINARY);
+    PROFILE_STAGE(Stage::Filters);
+    if (src.empty()) return;
+    FrameScope frame;
+    Mat& g = FrameArena::local().acquire(src.size(), CV_8UC1);
+    if(src.channels()==4) cvtColor(src, g, COLOR_RGBA2GRAY); else cvtColor(src, g, COLOR_BGR2GRAY);
+    binaryGray(g);
     cvtColor(g, src, COLOR_GRAY2RGBA);
 }
 
 void applyMorphOpen(Mat& src) {
+    PROFILE_STAGE(Stage::Filters);
     morphologyEx(src, src, MORPH_OPEN, getStructuringElement(MORPH_RECT, Size(5,5)));
 }
 
 void applyMorphClose(Mat& src) {
+    PROFILE_STAGE(Stage::Filters);
     morphologyEx(src, src, MORPH_CLOSE, getStructuringElement(MORPH_RECT, Size(5,5)));
 }
 
 void applyBlur(Mat& src) {
+    PROFILE_STAGE(Stage::Filters);
     GaussianBlur(src, src, Size(15,15), 0);
 }
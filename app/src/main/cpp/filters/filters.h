@@ -1,14 +1,48 @@
 #pragma once
-#include <jni.h>
+#include "TemporalLut.h"
 #include <opencv2/opencv.hpp>
 
+// Default skin smoothing strength, 0 = off, 1 = full
+constexpr float kDefaultBeautyStrength = 0.7f;
+
 void applyBeauty(cv::Mat& src);
+void applyBeauty(cv::Mat& src, float strength);
 void applyDehaze(cv::Mat& src);
 void applyUnderwater(cv::Mat& src);
+// Stage vignette: full brightness inside `radius`, fading to black over
+// `falloff`; both relative to the shorter image side.
+constexpr float kDefaultStageRadius = 0.5f;
+constexpr float kDefaultStageFalloff = 0.5f;
+
 void applyStage(cv::Mat& src);
+void applyStage(cv::Mat& src, float radius, float falloff);
 void applyGray(cv::Mat& src);
 void applyHistEq(cv::Mat& src);
 void applyBinary(cv::Mat& src);
 void applyMorphOpen(cv::Mat& src);
 void applyMorphClose(cv::Mat& src);
 void applyBlur(cv::Mat& src);
+
+// Video mode: HistEq and Dehaze keep per-thread tone LUTs across frames
+// (see TemporalLut) instead of equalizing each frame from scratch, which
+// removes their flicker. Off for still images.
+void setFilterVideoMode(bool enabled, const TemporalLutConfig& config = TemporalLutConfig());
+
+// Colour-space specific kernels shared by the apply* wrappers and
+// FilterPipeline. They work in place on 8-bit BGR or single-channel data.
+void beautyBGR(cv::Mat& bgr, float strength);
+void dehazeBGR(cv::Mat& bgr);
+void underwaterBGR(cv::Mat& bgr);
+void histEqBGR(cv::Mat& bgr);
+void binaryGray(cv::Mat& gray);
+// Works directly on 1, 3 or 4 channel 8-bit data (alpha is left untouched)
+void stageVignette(cv::Mat& img, float radius, float falloff);
+
+// Luma kernels for the YUV ingestion path. Input is a camera Y plane in
+// BT.601 video range (16-235); dst never aliases it, since camera buffers are
+// read-only. Gray/binary output is full range, ready for GRAY2RGBA; the
+// equalized and CLAHE planes stay in video range for YUV->RGBA.
+void grayFromLuma(const cv::Mat& y, cv::Mat& dst);
+void binaryFromLuma(const cv::Mat& y, cv::Mat& dst);
+void equalizeLuma(const cv::Mat& y, cv::Mat& dst);
+void dehazeLuma(const cv::Mat& y, cv::Mat& dst);
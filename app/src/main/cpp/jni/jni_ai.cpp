@@ -4,6 +4,56 @@
 #include <vector>
 #include "../ai/AIController.h"
 #include "../utils/utils.h"
+#include "../utils/json.h"
+#include "../utils/profiler.h"
+
+static std::vector<int> readClassIds(JNIEnv* env, jintArray activeClassIds) {
+    std::vector<int> allowedClasses;
+    if (activeClassIds != nullptr) {
+        jsize len = env->GetArrayLength(activeClassIds);
+        jint *body = env->GetIntArrayElements(activeClassIds, 0);
+        for (int i = 0; i < len; i++) {
+            allowedClasses.push_back(body[i]);
+        }
+        env->ReleaseIntArrayElements(activeClassIds, body, 0);
+    }
+    return allowedClasses;
+}
+
+static jstring resultsToJson(JNIEnv* env, const std::vector<YoloResult>& results) {
+    std::stringstream json;
+    json << "[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i > 0) json << ",";
+        json << "{";
+        json << '"' << "label" << '"' << ":" << jsonString(results[i].label) << ", ";
+        json << '"' << "conf" << '"' << ":" << results[i].confidence << ", ";
+        json << '"' << "track" << '"' << ":" << results[i].trackId << ", ";
+        json << '"' << "box" << '"' << ":[" << results[i].x << "," << results[i].y << "," << results[i].width << "," << results[i].height << "]";
+        json << "}";
+    }
+    json << "]";
+    
+    return env->NewStringUTF(json.str().c_str());
+}
+
+// Packs results into a direct ByteBuffer (native byte order), returns records written
+static jint packToBuffer(JNIEnv* env, const std::vector<YoloResult>& results, jobject out) {
+    auto* dst = (float*)env->GetDirectBufferAddress(out);
+    if (dst == nullptr) return -1; // not a direct buffer
+    jlong capacity = env->GetDirectBufferCapacity(out) / (jlong)(kPackedResultFloats * sizeof(float));
+    return packResults(results, dst, (int)capacity);
+}
+
+// Packs results into a reused float[], returns records written
+static jint packToArray(JNIEnv* env, const std::vector<YoloResult>& results, jfloatArray out) {
+    jsize capacity = env->GetArrayLength(out) / kPackedResultFloats;
+    auto* dst = (float*)env->GetPrimitiveArrayCritical(out, nullptr);
+    if (dst == nullptr) return -1;
+    int count = packResults(results, dst, capacity);
+    env->ReleasePrimitiveArrayCritical(out, dst, 0);
+    return count;
+}
 
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_mirror2922_ecvl_NativeLib_initYolo(JNIEnv *env, jobject, jstring model_path) {
@@ -27,34 +77,174 @@ Java_com_mirror2922_ecvl_NativeLib_setHardwareBackend(JNIEnv *env, jobject, jstr
     env->ReleaseStringUTFChars(backend, b);
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setOrtSessionConfig(JNIEnv*, jobject, jint intraOpThreads, jint interOpThreads,
+                                                      jboolean allowSpinning, jboolean parallelExecution) {
+    OrtSessionConfig config;
+    config.intraOpThreads = intraOpThreads;
+    config.interOpThreads = interOpThreads;
+    config.allowSpinning = allowSpinning;
+    config.parallelExecution = parallelExecution;
+    // An explicit thread count asks for a private per-session pool
+    config.sharedThreadPool = intraOpThreads <= 0;
+    setAIOrtConfig(config);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setModelCacheDir(JNIEnv *env, jobject, jstring dir) {
+    const char* d = env->GetStringUTFChars(dir, nullptr);
+    setAIModelCacheDir(std::string(d));
+    env->ReleaseStringUTFChars(dir, d);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setEngineWarmup(JNIEnv*, jobject, jboolean enabled) {
+    setAIWarmup(enabled);
+}
+
+extern "C" JNIEXPORT jfloat JNICALL
+Java_com_mirror2922_ecvl_NativeLib_getTimeToFirstDetectionMs(JNIEnv*, jobject) {
+    return getAITimeToFirstDetectionMs();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setAsyncInference(JNIEnv*, jobject, jboolean enabled) {
+    setAIAsync(enabled);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setDetectionInterval(JNIEnv*, jobject, jint frames) {
+    setAIDetectionInterval(frames);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setNmsConfig(JNIEnv*, jobject, jboolean classAgnostic, jint maxCandidates,
+                                               jint maxDetections) {
+    NmsConfig config;
+    config.classAgnostic = classAgnostic;
+    config.maxCandidates = maxCandidates;
+    config.maxDetections = maxDetections;
+    setAINmsConfig(config);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setMotionGate(JNIEnv*, jobject, jboolean enabled, jfloat blockThreshold,
+                                                jfloat runFraction, jint maxStaleFrames, jboolean regionDetection) {
+    MotionGateConfig config;
+    config.enabled = enabled;
+    config.blockThreshold = blockThreshold;
+    config.runFraction = runFraction;
+    config.maxStaleFrames = maxStaleFrames;
+    config.regionDetection = regionDetection;
+    setAIMotionGate(config);
+}
+
+extern "C" JNIEXPORT jfloat JNICALL
+Java_com_mirror2922_ecvl_NativeLib_getMotionSkipRatio(JNIEnv*, jobject) {
+    return getAIMotionSkipRatio();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setDrawOverlay(JNIEnv*, jobject, jboolean enabled) {
+    setAIDrawOverlay(enabled);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setTiledDetection(JNIEnv*, jobject, jboolean enabled, jfloat overlap,
+                                                    jint maxTiles, jboolean globalView) {
+    TilingConfig config;
+    config.enabled = enabled;
+    config.overlap = overlap;
+    config.maxTiles = maxTiles;
+    config.globalView = globalView;
+    setAITiling(config);
+}
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_mirror2922_ecvl_NativeLib_getClassNames(JNIEnv* env, jobject) {
+    std::vector<std::string> names = getAIClassNames();
+    jobjectArray array = env->NewObjectArray((jsize)names.size(), env->FindClass("java/lang/String"), nullptr);
+    for (size_t i = 0; i < names.size(); ++i) {
+        jstring name = env->NewStringUTF(names[i].c_str());
+        env->SetObjectArrayElement(array, (jsize)i, name);
+        env->DeleteLocalRef(name);
+    }
+    return array;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_mirror2922_ecvl_NativeLib_getResultFrameId(JNIEnv*, jobject) {
+    return (jlong)getAIResultFrameId();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setActiveClasses(JNIEnv* env, jobject, jintArray activeClassIds) {
+    setAIActiveClasses(readClassIds(env, activeClassIds));
+}
+
+// JSON result path, kept for debugging; the packed variants below avoid the string round trip
 extern "C" JNIEXPORT jstring JNICALL
 Java_com_mirror2922_ecvl_NativeLib_yoloInference(JNIEnv *env, jobject, jlong matAddr, jfloat conf, jfloat iou, jintArray activeClassIds) {
-    std::vector<int> allowedClasses;
-    if (activeClassIds != nullptr) {
-        jsize len = env->GetArrayLength(activeClassIds);
-        jint *body = env->GetIntArrayElements(activeClassIds, 0);
-        for (int i = 0; i < len; i++) {
-            allowedClasses.push_back(body[i]);
-        }
-        env->ReleaseIntArrayElements(activeClassIds, body, 0);
-    }
+    std::vector<int> allowedClasses = readClassIds(env, activeClassIds);
 
     cv::Mat& frame = getMat(matAddr);
     
     // Run inference and draw results on the frame
     std::vector<YoloResult> results = runAIInference(frame, conf, iou, allowedClasses);
-    
-    std::stringstream json;
-    json << "[";
-    for (size_t i = 0; i < results.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "{";
-        json << '"' << "label" << '"' << ":" << '"' << results[i].label << '"' << ", ";
-        json << '"' << "conf" << '"' << ":" << results[i].confidence << ", ";
-        json << '"' << "box" << '"' << ":[" << results[i].x << "," << results[i].y << "," << results[i].width << "," << results[i].height << "]";
-        json << "}";
-    }
-    json << "]";
-    
-    return env->NewStringUTF(json.str().c_str());
-}
\ No newline at end of file
+    return resultsToJson(env, results);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mirror2922_ecvl_NativeLib_yuvInference(
+    JNIEnv* env, jobject,
+    jobject yBuffer, jint yRowStride,
+    jobject uBuffer, jint uRowStride,
+    jobject vBuffer, jint vRowStride,
+    jint pixelStride,
+    jint width, jint height,
+    jfloat conf, jfloat iou, jintArray activeClassIds) {
+    std::vector<int> allowedClasses = readClassIds(env, activeClassIds);
+    YuvPlanes planes = getYuvPlanes(env, yBuffer, yRowStride, uBuffer, uRowStride, vBuffer, vRowStride,
+                                    pixelStride, width, height);
+
+    // Inference-only frame: YUV goes straight into the letterboxed detector input
+    std::vector<YoloResult> results = runAIInferenceYuv(planes, conf, iou, allowedClasses);
+    return resultsToJson(env, results);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_mirror2922_ecvl_NativeLib_yoloInferencePacked(JNIEnv* env, jobject, jlong matAddr, jfloat conf, jfloat iou, jobject outBuffer) {
+    std::vector<YoloResult> results = runAIInference(getMat(matAddr), conf, iou);
+    return packToBuffer(env, results, outBuffer);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_mirror2922_ecvl_NativeLib_yoloInferenceArray(JNIEnv* env, jobject, jlong matAddr, jfloat conf, jfloat iou, jfloatArray outArray) {
+    std::vector<YoloResult> results = runAIInference(getMat(matAddr), conf, iou);
+    return packToArray(env, results, outArray);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_mirror2922_ecvl_NativeLib_yuvInferencePacked(
+    JNIEnv* env, jobject,
+    jobject yBuffer, jint yRowStride,
+    jobject uBuffer, jint uRowStride,
+    jobject vBuffer, jint vRowStride,
+    jint pixelStride,
+    jint width, jint height,
+    jfloat conf, jfloat iou, jobject outBuffer) {
+    YuvPlanes planes = getYuvPlanes(env, yBuffer, yRowStride, uBuffer, uRowStride, vBuffer, vRowStride,
+                                    pixelStride, width, height);
+    std::vector<YoloResult> results = runAIInferenceYuv(planes, conf, iou);
+    return packToBuffer(env, results, outBuffer);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mirror2922_ecvl_NativeLib_getStageTimings(JNIEnv* env, jobject) {
+    return env->NewStringUTF(stageTimingsJson().c_str());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_resetStageTimings(JNIEnv*, jobject) {
+    resetStageTimings();
+}
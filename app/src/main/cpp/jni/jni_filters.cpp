@@ -1,5 +1,7 @@
 #include <jni.h>
+#include <vector>
 #include "../filters/filters.h"
+#include "../filters/FilterPipeline.h"
 #include "../utils/utils.h"
 
 extern "C" JNIEXPORT void JNICALL
@@ -7,6 +9,11 @@ Java_com_mirror2922_ecvl_NativeLib_applyBeautyFilter(JNIEnv*, jobject, jlong mat
     applyBeauty(getMat(matAddr));
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_applyBeautyFilterStrength(JNIEnv*, jobject, jlong matAddr, jfloat strength) {
+    applyBeauty(getMat(matAddr), strength);
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_mirror2922_ecvl_NativeLib_applyDehaze(JNIEnv*, jobject, jlong matAddr) {
     applyDehaze(getMat(matAddr));
@@ -22,6 +29,11 @@ Java_com_mirror2922_ecvl_NativeLib_applyStage(JNIEnv*, jobject, jlong matAddr) {
     applyStage(getMat(matAddr));
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_applyStageVignette(JNIEnv*, jobject, jlong matAddr, jfloat radius, jfloat falloff) {
+    applyStage(getMat(matAddr), radius, falloff);
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_mirror2922_ecvl_NativeLib_applyGray(JNIEnv*, jobject, jlong matAddr) {
     applyGray(getMat(matAddr));
@@ -51,3 +63,36 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_mirror2922_ecvl_NativeLib_applyBlur(JNIEnv*, jobject, jlong matAddr) {
     applyBlur(getMat(matAddr));
 }
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setFilterChain(JNIEnv* env, jobject, jobjectArray filterNames) {
+    std::vector<FilterOp> ops;
+    jsize len = filterNames != nullptr ? env->GetArrayLength(filterNames) : 0;
+    for (jsize i = 0; i < len; ++i) {
+        auto name = (jstring)env->GetObjectArrayElement(filterNames, i);
+        const char* n = env->GetStringUTFChars(name, nullptr);
+        FilterOp op;
+        if (filterOpFromName(n, op)) ops.push_back(op);
+        env->ReleaseStringUTFChars(name, n);
+        env->DeleteLocalRef(name);
+    }
+    setFilterChain(ops);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setFilterChainBeautyStrength(JNIEnv*, jobject, jfloat strength) {
+    setFilterChainBeautyStrength(strength);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setFilterVideoMode(JNIEnv*, jobject, jboolean enabled, jint updateInterval, jfloat smoothing) {
+    TemporalLutConfig config;
+    config.updateInterval = updateInterval;
+    config.smoothing = smoothing;
+    setFilterVideoMode(enabled, config);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_applyFilterChain(JNIEnv*, jobject, jlong matAddr) {
+    applyFilterChain(getMat(matAddr));
+}
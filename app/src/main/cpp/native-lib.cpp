@@ -1,7 +1,24 @@
 #include <jni.h>
 #include <string>
+#include "utils/threadpool.h"
+
+// OpenCV runs on the shared pool from the first frame, whether or not a
+// detector is ever loaded
+extern "C" JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM*, void*) {
+    installSharedThreadPool();
+    return JNI_VERSION_1_6;
+}
 
 extern "C" JNIEXPORT jstring JNICALL
 Java_com_mirror2922_ecvl_NativeLib_stringFromJNI(JNIEnv* env, jobject) {
     return env->NewStringUTF("BeautyApp Native Modular Engine Loaded");
 }
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mirror2922_ecvl_NativeLib_setThreadPool(JNIEnv*, jobject, jint threads, jboolean performanceCoresOnly) {
+    ThreadPoolConfig config;
+    config.threads = threads;
+    config.performanceCoresOnly = performanceCoresOnly;
+    configureSharedThreadPool(config);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+// Process-wide allocation counters for the host tools.
+// Counts global operator new and cv::Mat buffer allocations.
+namespace alloc_counter {
+
+struct Snapshot {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+// Installs the counting cv::MatAllocator as OpenCV's default allocator.
+void install();
+
+Snapshot snapshot();
+
+inline Snapshot operator-(const Snapshot& a, const Snapshot& b) {
+    return {a.count - b.count, a.bytes - b.bytes};
+}
+
+} // namespace alloc_counter
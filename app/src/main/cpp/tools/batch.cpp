@@ -0,0 +1,394 @@
+// Offline processing of recorded footage or photo folders with the app's
+// filters and detectors. Frames flow through concurrent stages connected by
+// bounded queues:
+//
+//   decode (1) -> filter chain (--filter-threads) -> detect (--engines) -> draw/encode/write (1)
+//
+// Each detect worker owns its own engine instance, so throughput scales with
+// cores; the sink restores frame order before writing.
+//
+// usage: beautyapp_batch --input video.mp4|image_dir [--model yolo.onnx] [--engine ort|dnn]
+//                        [--filters Beauty,Dehaze] [--engines N] [--filter-threads N] [--queue N]
+//                        [--conf 0.25] [--iou 0.45] [--format jsonl|bin] [--output FILE]
+//                        [--video-out out.mp4]
+//
+// --format bin writes, per frame: uint32 frame index, uint32 detection count,
+// then count records of kPackedResultFloats native-order floats (see ai/types.h).
+#include "../filters/FilterPipeline.h"
+#include "../ai/engine/DNNEngine.h"
+#include "../ai/engine/OrtEngine.h"
+#include "../ai/OverlayRenderer.h"
+#include "../utils/json.h"
+#include "../utils/threadpool.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+// Frame rate for --video-out: the input video's, or 30 for image folders
+atomic<double> g_sourceFps{30.0};
+
+struct BatchOptions {
+    string input;
+    string modelPath;
+    string engine = "ort";
+    vector<FilterOp> filters;
+    int engines = 0;       // 0 = one per two cores
+    int filterThreads = 1;
+    int queueDepth = 8;
+    float conf = 0.25f;
+    float iou = 0.45f;
+    bool binary = false;
+    string output;         // empty = stdout
+    string videoOut;
+};
+
+struct Frame {
+    int64_t index = 0;
+    string source; // file name for image folders, empty for video
+    Mat image;     // RGBA, like camera frames
+    vector<YoloResult> results;
+};
+
+// Blocking FIFO with a capacity: producers wait while it is full, so a slow
+// stage throttles the ones before it instead of buffering the whole input
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(max<size_t>(1, capacity)) {}
+
+    void push(T item) {
+        unique_lock<mutex> lock(m);
+        notFull.wait(lock, [this] { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    // False once the queue is closed and drained
+    bool pop(T& item) {
+        unique_lock<mutex> lock(m);
+        notEmpty.wait(lock, [this] { return !items.empty() || producers == 0; });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void addProducers(int n) {
+        lock_guard<mutex> lock(m);
+        producers += n;
+    }
+
+    // Called by each producer when it is done; the last one closes the queue
+    void producerDone() {
+        lock_guard<mutex> lock(m);
+        if (--producers == 0) notEmpty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    deque<T> items;
+    int producers = 0;
+    mutex m;
+    condition_variable notEmpty;
+    condition_variable notFull;
+};
+
+using FrameQueue = BoundedQueue<unique_ptr<Frame>>;
+
+// Wall time a stage spent working (not waiting on its queues)
+struct StageTimer {
+    atomic<int64_t> busyUs{0};
+    atomic<int64_t> frames{0};
+
+    void add(Clock::time_point start) {
+        busyUs += chrono::duration_cast<chrono::microseconds>(Clock::now() - start).count();
+        ++frames;
+    }
+    double avgMs() const { return frames ? busyUs / 1000.0 / frames : 0.0; }
+};
+
+bool parseFilters(const string& list, vector<FilterOp>& out) {
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        string token = list.substr(start, comma == string::npos ? string::npos : comma - start);
+        FilterOp op;
+        if (!filterOpFromName(token, op)) {
+            fprintf(stderr, "Unknown filter: %s\n", token.c_str());
+            return false;
+        }
+        out.push_back(op);
+        if (comma == string::npos) break;
+        start = comma + 1;
+    }
+    return true;
+}
+
+bool parseArgs(int argc, char** argv, BatchOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--input" && hasValue) opts.input = argv[++i];
+        else if (arg == "--model" && hasValue) opts.modelPath = argv[++i];
+        else if (arg == "--engine" && hasValue) opts.engine = argv[++i];
+        else if (arg == "--engines" && hasValue) opts.engines = max(1, atoi(argv[++i]));
+        else if (arg == "--filter-threads" && hasValue) opts.filterThreads = max(1, atoi(argv[++i]));
+        else if (arg == "--queue" && hasValue) opts.queueDepth = max(1, atoi(argv[++i]));
+        else if (arg == "--conf" && hasValue) opts.conf = (float)atof(argv[++i]);
+        else if (arg == "--iou" && hasValue) opts.iou = (float)atof(argv[++i]);
+        else if (arg == "--output" && hasValue) opts.output = argv[++i];
+        else if (arg == "--video-out" && hasValue) opts.videoOut = argv[++i];
+        else if (arg == "--format" && hasValue) {
+            string format = argv[++i];
+            if (format != "jsonl" && format != "bin") {
+                fprintf(stderr, "Unknown format: %s\n", format.c_str());
+                return false;
+            }
+            opts.binary = format == "bin";
+        } else if (arg == "--filters" && hasValue) {
+            if (!parseFilters(argv[++i], opts.filters)) return false;
+        } else {
+            opts.input.clear();
+            break;
+        }
+    }
+    if (opts.input.empty() || (opts.engine != "ort" && opts.engine != "dnn")) {
+        fprintf(stderr,
+                "usage: %s --input video.mp4|image_dir [--model yolo.onnx] [--engine ort|dnn]\n"
+                "       [--filters Beauty,Dehaze] [--engines N] [--filter-threads N] [--queue N]\n"
+                "       [--conf 0.25] [--iou 0.45] [--format jsonl|bin] [--output FILE] [--video-out out.mp4]\n",
+                argv[0]);
+        return false;
+    }
+    if (opts.engines == 0) opts.engines = max(1, (int)thread::hardware_concurrency() / 2);
+    return true;
+}
+
+unique_ptr<Engine> makeEngine(const BatchOptions& opts) {
+    if (opts.engine == "dnn") return make_unique<DNNEngine>();
+    auto ort = make_unique<OrtEngine>();
+    // Throughput over latency: engines run side by side, so each gets a
+    // private pool sized to its share of the cores instead of contending for the shared one
+    OrtSessionConfig config;
+    config.sharedThreadPool = false;
+    config.allowSpinning = false;
+    config.intraOpThreads = max(1, (int)thread::hardware_concurrency() / opts.engines);
+    ort->setSessionConfig(config);
+    return ort;
+}
+
+void decodeStage(const BatchOptions& opts, FrameQueue& out, StageTimer& timer) {
+    auto emit = [&](int64_t index, string source, const Mat& bgr, Clock::time_point start) {
+        auto frame = make_unique<Frame>();
+        frame->index = index;
+        frame->source = std::move(source);
+        cvtColor(bgr, frame->image, COLOR_BGR2RGBA);
+        timer.add(start);
+        out.push(std::move(frame));
+    };
+
+    if (fs::is_directory(opts.input)) {
+        vector<fs::path> files;
+        for (const auto& entry : fs::directory_iterator(opts.input)) {
+            if (entry.is_regular_file() && haveImageReader(entry.path().string())) files.push_back(entry.path());
+        }
+        sort(files.begin(), files.end());
+        int64_t index = 0;
+        for (const auto& path : files) {
+            auto start = Clock::now();
+            Mat bgr = imread(path.string(), IMREAD_COLOR);
+            if (bgr.empty()) {
+                fprintf(stderr, "Skipping unreadable image %s\n", path.c_str());
+                continue;
+            }
+            emit(index++, path.filename().string(), bgr, start);
+        }
+    } else {
+        VideoCapture capture(opts.input);
+        if (!capture.isOpened()) {
+            fprintf(stderr, "Cannot open %s\n", opts.input.c_str());
+        } else {
+            const double fps = capture.get(CAP_PROP_FPS);
+            if (fps > 0) g_sourceFps = fps;
+            Mat bgr;
+            for (int64_t index = 0;; ++index) {
+                auto start = Clock::now();
+                if (!capture.read(bgr)) break;
+                emit(index, "", bgr, start);
+            }
+        }
+    }
+    out.producerDone();
+}
+
+void filterStage(const BatchOptions& opts, FrameQueue& in, FrameQueue& out, StageTimer& timer) {
+    FilterPipeline pipeline;
+    pipeline.setOps(opts.filters);
+    unique_ptr<Frame> frame;
+    while (in.pop(frame)) {
+        auto start = Clock::now();
+        pipeline.apply(frame->image);
+        timer.add(start);
+        out.push(std::move(frame));
+    }
+    out.producerDone();
+}
+
+void detectStage(const BatchOptions& opts, Engine* engine, FrameQueue& in, FrameQueue& out, StageTimer& timer) {
+    const vector<int> allowedClasses;
+    unique_ptr<Frame> frame;
+    while (in.pop(frame)) {
+        auto start = Clock::now();
+        if (engine) frame->results = engine->detect(frame->image, opts.conf, opts.iou, allowedClasses);
+        timer.add(start);
+        out.push(std::move(frame));
+    }
+    out.producerDone();
+}
+
+void writeJson(FILE* out, const Frame& frame) {
+    fprintf(out, "{\"frame\":%lld", (long long)frame.index);
+    if (!frame.source.empty()) {
+        fprintf(out, ",\"source\":%s", jsonString(frame.source).c_str());
+    }
+    fprintf(out, ",\"detections\":[");
+    for (size_t i = 0; i < frame.results.size(); ++i) {
+        const YoloResult& res = frame.results[i];
+        fprintf(out, "%s{\"label\":%s,\"classId\":%d,\"conf\":%.4f,\"box\":[%.1f,%.1f,%.1f,%.1f]}",
+                i ? "," : "", jsonString(res.label).c_str(), res.classId, res.confidence, res.x, res.y, res.width, res.height);
+    }
+    fprintf(out, "]}\n");
+}
+
+void writeBinary(FILE* out, const Frame& frame, vector<float>& packed) {
+    const uint32_t header[2] = {(uint32_t)frame.index, (uint32_t)frame.results.size()};
+    packed.resize(frame.results.size() * kPackedResultFloats);
+    packResults(frame.results, packed.data(), (int)frame.results.size());
+    fwrite(header, sizeof(header), 1, out);
+    fwrite(packed.data(), sizeof(float), packed.size(), out);
+}
+
+// Single consumer: restores input order, then draws, encodes and writes
+int64_t sinkStage(const BatchOptions& opts, FrameQueue& in, FILE* out, StageTimer& timer) {
+    map<int64_t, unique_ptr<Frame>> pending;
+    int64_t next = 0;
+    OverlayRenderer overlay;
+    VideoWriter writer;
+    Size writerSize;
+    Mat bgr;
+    vector<float> packed;
+
+    auto write = [&](Frame& frame) {
+        if (opts.binary) writeBinary(out, frame, packed);
+        else writeJson(out, frame);
+        if (opts.videoOut.empty()) return;
+        overlay.draw(frame.image, frame.results);
+        cvtColor(frame.image, bgr, COLOR_RGBA2BGR);
+        if (writerSize.empty()) {
+            // Sized by the first frame; photo folders of mixed sizes are scaled to it
+            writerSize = bgr.size();
+            writer.open(opts.videoOut, VideoWriter::fourcc('m', 'p', '4', 'v'), g_sourceFps.load(), writerSize);
+            if (!writer.isOpened()) fprintf(stderr, "Cannot open %s for writing\n", opts.videoOut.c_str());
+        }
+        if (!writer.isOpened()) return;
+        if (bgr.size() != writerSize) resize(bgr, bgr, writerSize, 0, 0, INTER_AREA);
+        writer.write(bgr);
+    };
+
+    unique_ptr<Frame> frame;
+    while (in.pop(frame)) {
+        auto start = Clock::now();
+        pending.emplace(frame->index, std::move(frame));
+        // Indices are dense (unreadable images never get one), so frames
+        // leave strictly in input order
+        while (!pending.empty() && pending.begin()->first == next) {
+            write(*pending.begin()->second);
+            pending.erase(pending.begin());
+            ++next;
+        }
+        timer.add(start);
+    }
+    for (auto& entry : pending) write(*entry.second);
+    fflush(out);
+    return timer.frames;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BatchOptions opts;
+    if (!parseArgs(argc, argv, opts)) return 1;
+    installSharedThreadPool(); // as JNI_OnLoad does in the app
+
+    vector<unique_ptr<Engine>> engines;
+    if (!opts.modelPath.empty()) {
+        for (int i = 0; i < opts.engines; ++i) {
+            auto engine = makeEngine(opts);
+            if (!engine->loadModel(opts.modelPath)) {
+                fprintf(stderr, "Failed to load %s\n", opts.modelPath.c_str());
+                return 1;
+            }
+            engines.push_back(std::move(engine));
+        }
+    } else {
+        fprintf(stderr, "No --model given, running filters only\n");
+        opts.engines = 1;
+    }
+
+    FILE* out = opts.output.empty() ? stdout : fopen(opts.output.c_str(), opts.binary ? "wb" : "w");
+    if (!out) {
+        fprintf(stderr, "Cannot open %s for writing\n", opts.output.c_str());
+        return 1;
+    }
+
+    FrameQueue decoded(opts.queueDepth), filtered(opts.queueDepth), detected(opts.queueDepth);
+    decoded.addProducers(1);
+    filtered.addProducers(opts.filterThreads);
+    detected.addProducers(opts.engines);
+    StageTimer decodeTime, filterTime, detectTime, sinkTime;
+
+    auto t0 = Clock::now();
+    vector<thread> threads;
+    threads.emplace_back(decodeStage, cref(opts), ref(decoded), ref(decodeTime));
+    for (int i = 0; i < opts.filterThreads; ++i) {
+        threads.emplace_back(filterStage, cref(opts), ref(decoded), ref(filtered), ref(filterTime));
+    }
+    for (int i = 0; i < opts.engines; ++i) {
+        Engine* engine = engines.empty() ? nullptr : engines[i].get();
+        threads.emplace_back(detectStage, cref(opts), engine, ref(filtered), ref(detected), ref(detectTime));
+    }
+    const int64_t frames = sinkStage(opts, detected, out, sinkTime);
+    for (auto& t : threads) t.join();
+    const double seconds = chrono::duration<double>(Clock::now() - t0).count();
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "%lld frames in %.2f s: %.1f fps (%d engines, %d filter threads)\n",
+            (long long)frames, seconds, seconds > 0 ? frames / seconds : 0.0, opts.engines, opts.filterThreads);
+    fprintf(stderr, "avg ms/frame per worker: decode %.2f, filter %.2f, detect %.2f, sink %.2f\n",
+            decodeTime.avgMs(), filterTime.avgMs(), detectTime.avgMs(), sinkTime.avgMs());
+    return 0;
+}
@@ -0,0 +1,390 @@
+// Host microbenchmark: times every filter and both detection engines across
+// common frame sizes, reporting p50/p99 latency and allocations per frame.
+//
+// usage: beautyapp_bench [--model yolo.onnx] [--iters N] [--warmup N] [--sizes 720p,1080p,4k]
+//                        [--cache-dir DIR]
+#include "alloc_counter.h"
+#include "../filters/filters.h"
+#include "../filters/FilterPipeline.h"
+#include "../utils/yuv.h"
+#include "../utils/arena.h"
+#include "../utils/profiler.h"
+#include "../utils/threadpool.h"
+#include "../ai/engine/DNNEngine.h"
+#include "../ai/engine/OrtEngine.h"
+#include "../ai/TiledDetector.h"
+#include "../ai/engine/Nms.h"
+#include "../ai/MotionGate.h"
+#include "../ai/OverlayRenderer.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+struct FrameSize {
+    const char* name;
+    int width;
+    int height;
+};
+
+const FrameSize kFrameSizes[] = {
+    {"720p", 1280, 720},
+    {"1080p", 1920, 1080},
+    {"4k", 3840, 2160},
+};
+
+struct FilterCase {
+    const char* name;
+    void (*apply)(Mat&);
+};
+
+const FilterCase kFilters[] = {
+    {"Beauty", applyBeauty},
+    {"Dehaze", applyDehaze},
+    {"Underwater", applyUnderwater},
+    {"Stage", applyStage},
+    {"Gray", applyGray},
+    {"HistEq", applyHistEq},
+    {"Binary", applyBinary},
+    {"MorphOpen", applyMorphOpen},
+    {"MorphClose", applyMorphClose},
+    {"Blur", applyBlur},
+};
+
+struct BenchOptions {
+    string modelPath;
+    string cacheDir; // ORT optimized-model cache, empty = disabled
+    int iterations = 50;
+    int warmup = 5;
+    vector<FrameSize> sizes;
+};
+
+struct BenchStats {
+    double p50Ms = 0;
+    double p99Ms = 0;
+    double allocsPerFrame = 0;
+    double kbPerFrame = 0;
+};
+
+double percentile(vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    sort(samples.begin(), samples.end());
+    size_t idx = (size_t)ceil(p * samples.size());
+    return samples[min(samples.size(), max<size_t>(idx, 1)) - 1];
+}
+
+// Runs `setup` untimed before each iteration, then times `body`.
+template <typename Setup, typename Body>
+BenchStats measure(const BenchOptions& opts, Setup&& setup, Body&& body) {
+    for (int i = 0; i < opts.warmup; ++i) {
+        setup();
+        body();
+    }
+
+    vector<double> samples;
+    samples.reserve(opts.iterations);
+    alloc_counter::Snapshot allocs;
+    for (int i = 0; i < opts.iterations; ++i) {
+        setup();
+        auto before = alloc_counter::snapshot();
+        auto t0 = Clock::now();
+        body();
+        auto t1 = Clock::now();
+        auto delta = alloc_counter::snapshot() - before;
+        allocs.count += delta.count;
+        allocs.bytes += delta.bytes;
+        samples.push_back(chrono::duration<double, milli>(t1 - t0).count());
+    }
+
+    BenchStats stats;
+    stats.p50Ms = percentile(samples, 0.50);
+    stats.p99Ms = percentile(samples, 0.99);
+    stats.allocsPerFrame = (double)allocs.count / opts.iterations;
+    stats.kbPerFrame = (double)allocs.bytes / 1024.0 / opts.iterations;
+    return stats;
+}
+
+// Deterministic, image-like RGBA frame (smoothed noise) so filters see real texture.
+Mat makeFrame(int width, int height) {
+    theRNG().state = 0x2922;
+    Mat frame(height, width, CV_8UC4);
+    randu(frame, Scalar::all(0), Scalar::all(255));
+    GaussianBlur(frame, frame, Size(0, 0), 3);
+    return frame;
+}
+
+void printHeader() {
+    printf("%-22s %-6s %10s %10s %12s %12s\n", "case", "size", "p50 ms", "p99 ms", "allocs/frm", "KB/frm");
+}
+
+void printRow(const string& name, const FrameSize& size, const BenchStats& s) {
+    printf("%-22s %-6s %10.3f %10.3f %12.1f %12.1f\n", name.c_str(), size.name, s.p50Ms, s.p99Ms, s.allocsPerFrame, s.kbPerFrame);
+    fflush(stdout);
+}
+
+bool parseSizes(const string& list, vector<FrameSize>& out) {
+    size_t start = 0;
+    while (true) {
+        size_t comma = list.find(',', start);
+        string token = list.substr(start, comma == string::npos ? string::npos : comma - start);
+        auto it = find_if(begin(kFrameSizes), end(kFrameSizes), [&](const FrameSize& f) { return token == f.name; });
+        if (it == end(kFrameSizes)) {
+            fprintf(stderr, "Unknown frame size: %s\n", token.c_str());
+            return false;
+        }
+        out.push_back(*it);
+        if (comma == string::npos) break;
+        start = comma + 1;
+    }
+    return true;
+}
+
+bool parseArgs(int argc, char** argv, BenchOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--model" && hasValue) opts.modelPath = argv[++i];
+        else if (arg == "--iters" && hasValue) opts.iterations = max(1, atoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue) opts.warmup = max(0, atoi(argv[++i]));
+        else if (arg == "--cache-dir" && hasValue) opts.cacheDir = argv[++i];
+        else if (arg == "--sizes" && hasValue) {
+            if (!parseSizes(argv[++i], opts.sizes)) return false;
+        } else {
+            fprintf(stderr, "usage: %s [--model yolo.onnx] [--iters N] [--warmup N] [--sizes 720p,1080p,4k] [--cache-dir DIR]\n", argv[0]);
+            return false;
+        }
+    }
+    if (opts.sizes.empty()) opts.sizes.assign(begin(kFrameSizes), end(kFrameSizes));
+    return true;
+}
+
+void benchFilters(const BenchOptions& opts) {
+    for (const auto& size : opts.sizes) {
+        Mat source = makeFrame(size.width, size.height);
+        Mat work(source.size(), source.type());
+        for (const auto& filter : kFilters) {
+            auto stats = measure(opts,
+                [&] {
+                    // Some filters change the Mat type in place; restore the RGBA frame.
+                    if (work.size() != source.size() || work.type() != source.type()) work.create(source.size(), source.type());
+                    source.copyTo(work);
+                },
+                [&] { filter.apply(work); });
+            printRow(filter.name, size, stats);
+        }
+
+        // Video mode: cached, temporally smoothed tone LUTs instead of per-frame histograms
+        setFilterVideoMode(true);
+        printRow("Dehaze(video)", size, measure(opts, [&] { source.copyTo(work); }, [&] { applyDehaze(work); }));
+        printRow("HistEq(video)", size, measure(opts, [&] { source.copyTo(work); }, [&] { applyHistEq(work); }));
+        setFilterVideoMode(false);
+
+        // Multi-filter preset: separate apply* calls vs one planned chain
+        auto sequential = measure(opts, [&] { source.copyTo(work); },
+            [&] { applyDehaze(work); applyBeauty(work); applyStage(work); });
+        printRow("Dehaze+Beauty+Stage", size, sequential);
+
+        FilterPipeline pipeline;
+        pipeline.setOps({FilterOp::Dehaze, FilterOp::Beauty, FilterOp::Stage});
+        auto chained = measure(opts, [&] { source.copyTo(work); }, [&] { pipeline.apply(work); });
+        printRow("FilterPipeline(same)", size, chained);
+
+        const FrameArena& arena = FrameArena::local();
+        printf("  arena: %zu buffers, %zu KB held, %llu allocations total\n",
+               arena.buffersHeld(), arena.bytesHeld() / 1024, (unsigned long long)arena.allocations());
+    }
+}
+
+// Synthetic YUV_420_888 frame in the two layouts cameras commonly deliver:
+// interleaved VU chroma (aliased NV21) and fully planar chroma.
+void benchYuv(const BenchOptions& opts) {
+    for (const auto& size : opts.sizes) {
+        Mat nv21(size.height * 3 / 2, size.width, CV_8UC1);
+        randu(nv21, Scalar::all(16), Scalar::all(235));
+        const uint8_t* vu = nv21.ptr<uint8_t>(size.height);
+
+        YuvPlanes aliased;
+        aliased.y = nv21.data;
+        aliased.v = vu;
+        aliased.u = vu + 1;
+        aliased.yRowStride = aliased.uRowStride = aliased.vRowStride = size.width;
+        aliased.uvPixelStride = 2;
+        aliased.width = size.width;
+        aliased.height = size.height;
+
+        Mat u(size.height / 2, size.width / 2, CV_8UC1), v(u.size(), CV_8UC1);
+        randu(u, Scalar::all(16), Scalar::all(240));
+        randu(v, Scalar::all(16), Scalar::all(240));
+        YuvPlanes planar = aliased;
+        planar.u = u.data;
+        planar.v = v.data;
+        planar.uRowStride = planar.vRowStride = size.width / 2;
+        planar.uvPixelStride = 1;
+
+        Mat rgba, letterboxed;
+        printRow("yuvToRgba(NV21)", size, measure(opts, [] {}, [&] { yuvToRgba(aliased, rgba); }));
+        printRow("yuvToRgba(planar)", size, measure(opts, [] {}, [&] { yuvToRgba(planar, rgba); }));
+        printRow("yuvToLetterbox(NV21)", size, measure(opts, [] {}, [&] { yuvToLetterbox(aliased, Size(640, 640), letterboxed); }));
+
+        // Per-frame price of deciding to skip the detector
+        MotionGateConfig gateConfig;
+        gateConfig.enabled = true;
+        MotionGate gate(gateConfig);
+        Mat luma(size.height, size.width, CV_8UC1, nv21.data);
+        printRow("MotionGate(Y plane)", size, measure(opts, [] {}, [&] { gate.updateLuma(luma); }));
+    }
+}
+
+double elapsedMs(Clock::time_point since) {
+    return chrono::duration<double, milli>(Clock::now() - since).count();
+}
+
+// Crowded-scene post-processing: thousands of overlapping candidates, as a
+// low confidence threshold produces. Size column is the candidate count.
+void benchNms(const BenchOptions& opts) {
+    const FrameSize crowd[] = {{"1k", 1000, 0}, {"5k", 5000, 0}};
+    for (const auto& size : crowd) {
+        RNG rng(0x2922);
+        DetectionCandidates candidates;
+        for (int i = 0; i < size.width; ++i) {
+            float w = rng.uniform(10.f, 200.f), h = rng.uniform(10.f, 200.f);
+            candidates.push(rng.uniform(0.f, 1920.f - w), rng.uniform(0.f, 1080.f - h), w, h,
+                            rng.uniform(0.25f, 1.f), rng.uniform(0, 80));
+        }
+        Nms nms;
+        vector<int> keep;
+        NmsConfig perClass, agnostic;
+        agnostic.classAgnostic = true;
+        printRow("Nms(per-class)", size, measure(opts, [] {}, [&] { nms.run(candidates, 0.45f, perClass, keep); }));
+        printRow("Nms(agnostic)", size, measure(opts, [] {}, [&] { nms.run(candidates, 0.45f, agnostic, keep); }));
+    }
+}
+
+// Overlay cost should track box perimeter, not label text, as the crowd grows
+void benchOverlay(const BenchOptions& opts) {
+    const FrameSize crowd[] = {{"10", 10, 0}, {"100", 100, 0}};
+    Mat frame = makeFrame(1920, 1080);
+    for (const auto& size : crowd) {
+        RNG rng(0x2922);
+        vector<YoloResult> results(size.width);
+        for (auto& res : results) {
+            res.width = rng.uniform(20.f, 300.f);
+            res.height = rng.uniform(20.f, 300.f);
+            res.x = rng.uniform(0.f, 1920.f - res.width);
+            res.y = rng.uniform(0.f, 1080.f - res.height);
+            res.confidence = rng.uniform(0.25f, 1.f);
+            res.classId = rng.uniform(0, 80);
+            res.label = "class" + to_string(res.classId);
+        }
+        OverlayRenderer overlay;
+        printRow("Overlay.draw", size, measure(opts, [] {}, [&] { overlay.draw(frame, results); }));
+    }
+}
+
+void benchEngine(const BenchOptions& opts, const char* name, unique_ptr<Engine> engine) {
+    auto* ort = dynamic_cast<OrtEngine*>(engine.get());
+    if (ort) ort->setCacheDirectory(opts.cacheDir);
+
+    auto t0 = Clock::now();
+    if (!engine->loadModel(opts.modelPath)) {
+        fprintf(stderr, "%s: failed to load %s\n", name, opts.modelPath.c_str());
+        return;
+    }
+    printf("%-22s load: %.1f ms\n", name, elapsedMs(t0));
+    if (ort && !opts.cacheDir.empty()) {
+        // Second load hits the optimized-model cache written by the first
+        t0 = Clock::now();
+        ort->loadModel(opts.modelPath);
+        printf("%-22s load (cached graph): %.1f ms\n", name, elapsedMs(t0));
+    }
+
+    // Cold first inference, the spike a background warm-up hides
+    const vector<int> allowedClasses;
+    Mat first = makeFrame(engine->inputSize().width, engine->inputSize().height);
+    t0 = Clock::now();
+    engine->detect(first, 0.25f, 0.45f, allowedClasses);
+    printf("%-22s first detect: %.1f ms\n", name, elapsedMs(t0));
+    // I/O bindings built during one phase. A new tiled batch size builds one
+    // on the phase's first frame; anything more is a steady-state rebind.
+    auto allocations = [&] { return ort ? ort->bufferAllocationCount() : 0; };
+    for (const auto& size : opts.sizes) {
+        Mat frame = makeFrame(size.width, size.height);
+        resetStageTimings();
+        const size_t detectStart = allocations();
+        auto stats = measure(opts, [] {}, [&] { engine->detect(frame, 0.25f, 0.45f, allowedClasses); });
+        printRow(string(name) + ".detect", size, stats);
+        printf("%-22s stages: %s\n", "", stageTimingsJson().c_str());
+
+        // Tail latency with a filter running back to back on another thread,
+        // both drawing from the shared pool
+        atomic<bool> stop{false};
+        thread filterLoad([&] {
+            Mat filtered = makeFrame(size.width, size.height);
+            while (!stop) applyBeauty(filtered);
+        });
+        auto loaded = measure(opts, [] {}, [&] { engine->detect(frame, 0.25f, 0.45f, allowedClasses); });
+        stop = true;
+        filterLoad.join();
+        printRow(string(name) + ".detect+beauty", size, loaded);
+
+        TilingConfig tiling;
+        tiling.enabled = true;
+        TiledDetector tiler(tiling);
+        const size_t views = tiler.planTiles(frame.size(), engine->inputSize()).size() + (tiling.globalView ? 1 : 0);
+        const size_t tiledStart = allocations();
+        auto tiled = measure(opts, [] {}, [&] { tiler.detect(*engine, frame, 0.25f, 0.45f, allowedClasses); });
+        printRow(string(name) + ".tiled(" + to_string(views) + ")", size, tiled);
+
+        // Shipped mix: tiled frames interleaved with batch-1 runs (motion regions,
+        // non-tiled frames). Each batch size keeps its own binding, so none are rebuilt.
+        const size_t mixedStart = allocations();
+        auto mixed = measure(opts, [] {}, [&] {
+            tiler.detect(*engine, frame, 0.25f, 0.45f, allowedClasses);
+            engine->detect(frame, 0.25f, 0.45f, allowedClasses);
+        });
+        printRow(string(name) + ".tiled+detect", size, mixed);
+        if (ort) {
+            printf("%-22s rebinds: detect %zu, tiled %zu (expect <= 1 each), interleaved %zu (expect 0)\n", "",
+                   tiledStart - detectStart, mixedStart - tiledStart, allocations() - mixedStart);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    if (!parseArgs(argc, argv, opts)) return 1;
+
+    installSharedThreadPool(); // as JNI_OnLoad does in the app
+    alloc_counter::install();
+    printHeader();
+    benchFilters(opts);
+    benchYuv(opts);
+    benchNms(opts);
+    benchOverlay(opts);
+
+    if (opts.modelPath.empty()) {
+        fprintf(stderr, "No --model given, skipping Engine::detect benchmarks\n");
+        return 0;
+    }
+    benchEngine(opts, "DNNEngine", make_unique<DNNEngine>());
+    benchEngine(opts, "OrtEngine", make_unique<OrtEngine>());
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "arena.h"
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+FrameArena& FrameArena::local() {
+    static thread_local FrameArena arena;
+    return arena;
+}
+
+Mat& FrameArena::acquire(Size size, int type) {
+    for (auto& slot : slots) {
+        if (!slot.inUse && slot.size == size && slot.type == type) {
+            slot.inUse = true;
+            slot.idleFrames = 0;
+            return slot.mat;
+        }
+    }
+    slots.emplace_back();
+    Slot& slot = slots.back();
+    slot.mat.create(size, type);
+    slot.size = size;
+    slot.type = type;
+    slot.inUse = true;
+    ++created;
+    return slot.mat;
+}
+
+void FrameArena::reset() {
+    for (auto& slot : slots) {
+        if (slot.inUse) {
+            // A caller may have let OpenCV reallocate the buffer; key it by what it holds now
+            slot.size = slot.mat.size();
+            slot.type = slot.mat.type();
+            slot.inUse = false;
+        } else {
+            ++slot.idleFrames;
+        }
+    }
+    slots.erase(remove_if(slots.begin(), slots.end(),
+                          [](const Slot& slot) { return slot.idleFrames > kMaxIdleFrames || slot.mat.empty(); }),
+                slots.end());
+}
+
+size_t FrameArena::bytesHeld() const {
+    size_t bytes = 0;
+    for (const auto& slot : slots) bytes += slot.mat.total() * slot.mat.elemSize();
+    return bytes;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Per-thread pool of reusable cv::Mat buffers for frame-sized temporaries.
+// Buffers handed out during a frame stay reserved until the outermost
+// FrameScope on the thread ends; the next frame gets the same allocations
+// back by size and type, so steady-state processing does not touch the heap.
+class FrameArena {
+public:
+    // The calling thread's arena
+    static FrameArena& local();
+
+    // Buffer of exactly this size and type, valid until the frame ends.
+    // Contents are undefined. Writing into it with OpenCV functions that
+    // produce the same size and type reuses the memory in place.
+    cv::Mat& acquire(cv::Size size, int type);
+    cv::Mat& acquire(int rows, int cols, int type) { return acquire(cv::Size(cols, rows), type); }
+
+    // Marks every buffer free; buffers unused for kMaxIdleFrames frames
+    // (e.g. after a resolution change) are released
+    void reset();
+
+    size_t buffersHeld() const { return slots.size(); }
+    size_t bytesHeld() const;
+    // Buffers created since the arena started; flat in steady state
+    uint64_t allocations() const { return created; }
+
+private:
+    static constexpr int kMaxIdleFrames = 30;
+
+    struct Slot {
+        cv::Mat mat;
+        cv::Size size;
+        int type = 0;
+        bool inUse = false;
+        int idleFrames = 0;
+    };
+
+    std::deque<Slot> slots; // deque: handed-out references survive growth
+    uint64_t created = 0;
+
+    friend class FrameScope;
+    int depth = 0;
+};
+
+// Frame boundary: the arena is reset when the outermost scope on the thread
+// ends, so nested filters and engines share one frame
+class FrameScope {
+public:
+    FrameScope() : arena(FrameArena::local()) { ++arena.depth; }
+    ~FrameScope() {
+        if (--arena.depth == 0) arena.reset();
+    }
+    FrameScope(const FrameScope&) = delete;
+    FrameScope& operator=(const FrameScope&) = delete;
+
+private:
+    FrameArena& arena;
+};
@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+
+// Quoted JSON string literal for text, escaping quotes, backslashes and
+// control characters. Labels come from model metadata or user sidecar files,
+// so they cannot be written raw.
+std::string jsonString(const std::string& text);
@@ -0,0 +1,19 @@
+#pragma once
+
+// Logging shim: routes to logcat on Android and to stderr on host builds,
+// so the core library does not depend on the NDK.
+#ifdef __ANDROID__
+#include <android/log.h>
+#define LOGD(tag, ...) __android_log_print(ANDROID_LOG_DEBUG, tag, __VA_ARGS__)
+#define LOGI(tag, ...) __android_log_print(ANDROID_LOG_INFO, tag, __VA_ARGS__)
+#define LOGW(tag, ...) __android_log_print(ANDROID_LOG_WARN, tag, __VA_ARGS__)
+#define LOGE(tag, ...) __android_log_print(ANDROID_LOG_ERROR, tag, __VA_ARGS__)
+#else
+#include <cstdio>
+#define ECVL_HOST_LOG(level, tag, ...) \
+    do { std::fprintf(stderr, "%s/%s: ", level, tag); std::fprintf(stderr, __VA_ARGS__); std::fputc('\n', stderr); } while (0)
+#define LOGD(tag, ...) ECVL_HOST_LOG("D", tag, __VA_ARGS__)
+#define LOGI(tag, ...) ECVL_HOST_LOG("I", tag, __VA_ARGS__)
+#define LOGW(tag, ...) ECVL_HOST_LOG("W", tag, __VA_ARGS__)
+#define LOGE(tag, ...) ECVL_HOST_LOG("E", tag, __VA_ARGS__)
+#endif
@@ -0,0 +1,83 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#ifdef __ANDROID__
+#include <android/trace.h>
+#endif
+
+namespace {
+
+StageHistogram g_histograms[(int)Stage::Count];
+
+float percentileOf(const std::vector<float>& sorted, float p) {
+    size_t idx = (size_t)(p * (sorted.size() - 1) + 0.5f);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+} // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::YuvConvert: return "YuvConvert";
+        case Stage::Filters: return "Filters";
+        case Stage::Preprocess: return "Preprocess";
+        case Stage::Inference: return "Inference";
+        case Stage::Decode: return "Decode";
+        case Stage::Nms: return "Nms";
+        case Stage::Draw: return "Draw";
+        default: return "Unknown";
+    }
+}
+
+uint32_t StageHistogram::percentiles(float& p50, float& p95, float& p99) const {
+    const uint32_t count = std::min(head.load(std::memory_order_relaxed), kCapacity);
+    p50 = p95 = p99 = 0.0f;
+    if (count == 0) return 0;
+    // Racing writers may overwrite a slot mid-copy; a stray sample is fine for a histogram
+    std::vector<float> sorted(count);
+    for (uint32_t i = 0; i < count; ++i) sorted[i] = samples[i].load(std::memory_order_relaxed);
+    std::sort(sorted.begin(), sorted.end());
+    p50 = percentileOf(sorted, 0.50f);
+    p95 = percentileOf(sorted, 0.95f);
+    p99 = percentileOf(sorted, 0.99f);
+    return count;
+}
+
+StageHistogram& stageHistogram(Stage stage) {
+    return g_histograms[(int)stage];
+}
+
+std::string stageTimingsJson() {
+    std::string json = "{";
+    char entry[160];
+    for (int i = 0; i < (int)Stage::Count; ++i) {
+        float p50, p95, p99;
+        uint32_t n = g_histograms[i].percentiles(p50, p95, p99);
+        if (n == 0) continue;
+        snprintf(entry, sizeof(entry), "%s\"%s\":{\"n\":%u,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f}",
+                 json.size() > 1 ? "," : "", stageName((Stage)i), n, p50, p95, p99);
+        json += entry;
+    }
+    return json + "}";
+}
+
+void resetStageTimings() {
+    for (auto& histogram : g_histograms) histogram.reset();
+}
+
+ScopedStage::ScopedStage(Stage stage) : stage(stage), start(std::chrono::steady_clock::now()) {
+#ifdef __ANDROID__
+    traced = ATrace_isEnabled();
+    if (traced) ATrace_beginSection(stageName(stage));
+#endif
+}
+
+ScopedStage::~ScopedStage() {
+    g_histograms[(int)stage].record(
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+#ifdef __ANDROID__
+    // endSection pops whatever is on top, so only pop what we pushed
+    if (traced) ATrace_endSection();
+#endif
+}
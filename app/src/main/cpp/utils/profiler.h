@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Per-stage latency instrumentation. Each stage keeps its most recent
+// samples in a lock-free ring, so recording from the camera, inference and
+// UI threads never blocks; snapshots sort a copy. On Android the scoped
+// timers also emit ATrace sections for systrace/Perfetto, which compile out
+// of host builds.
+enum class Stage {
+    YuvConvert,
+    Filters,
+    Preprocess,
+    Inference,
+    Decode,
+    Nms,
+    Draw,
+    Count
+};
+
+const char* stageName(Stage stage);
+
+class StageHistogram {
+public:
+    static constexpr uint32_t kCapacity = 512;
+
+    void record(float ms) {
+        uint32_t slot = head.fetch_add(1, std::memory_order_relaxed);
+        samples[slot % kCapacity].store(ms, std::memory_order_relaxed);
+    }
+    // Sample count (saturating at kCapacity) and percentiles over the ring
+    uint32_t percentiles(float& p50, float& p95, float& p99) const;
+    void reset() { head.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> head{0};
+    std::atomic<float> samples[kCapacity] = {};
+};
+
+StageHistogram& stageHistogram(Stage stage);
+
+// {"Inference":{"n":120,"p50":12.1,"p95":15.0,"p99":18.3}, ...}; stages without samples are omitted
+std::string stageTimingsJson();
+void resetStageTimings();
+
+class ScopedStage {
+public:
+    explicit ScopedStage(Stage stage);
+    ~ScopedStage();
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+    Stage stage;
+    std::chrono::steady_clock::time_point start;
+    bool traced = false;
+};
+
+#define ECVL_PROFILE_CONCAT_(a, b) a##b
+#define ECVL_PROFILE_CONCAT(a, b) ECVL_PROFILE_CONCAT_(a, b)
+// Times the rest of the enclosing scope as `stage`
+#define PROFILE_STAGE(stage) ScopedStage ECVL_PROFILE_CONCAT(profileStage_, __LINE__)(stage)
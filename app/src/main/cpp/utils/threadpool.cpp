@@ -0,0 +1,214 @@
+#include "threadpool.h"
+#include "log.h"
+#include <opencv2/core.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+// Enough chunks for stealing to even out bands, few enough to keep
+// per-chunk overhead negligible
+constexpr int kChunksPerThread = 4;
+
+thread_local int t_workerIndex = -1;
+
+mutex g_poolMutex;
+ThreadPoolConfig g_poolConfig;
+shared_ptr<ThreadPool> g_pool;
+
+class PoolParallelBackend : public cv::parallel::ParallelForAPI {
+public:
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body, void* data) override {
+        sharedThreadPool()->parallelFor(tasks, [body, data](int begin, int end) { body(begin, end, data); });
+    }
+    // -1 on threads the pool does not own (camera, inference worker...), so
+    // OpenCV never keys per-thread state on an id two such threads share
+    int getThreadNum() const override { return ThreadPool::threadIndex(); }
+    int getNumThreads() const override { return sharedThreadPool()->size(); }
+    // Sized by configureSharedThreadPool, not by cv::setNumThreads
+    int setNumThreads(int) override { return getNumThreads(); }
+    const char* getName() const override { return "ecvl"; }
+};
+
+} // namespace
+
+const vector<int>& performanceCores() {
+    static const vector<int> cores = [] {
+        const int cpus = max(1, (int)thread::hardware_concurrency());
+        vector<long> maxFreq(cpus, 0);
+        long lowest = LONG_MAX, highest = 0;
+        for (int i = 0; i < cpus; ++i) {
+            char path[96];
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", i);
+            if (FILE* f = fopen(path, "r")) {
+                if (fscanf(f, "%ld", &maxFreq[i]) != 1) maxFreq[i] = 0;
+                fclose(f);
+            }
+            if (maxFreq[i] > 0) {
+                lowest = min(lowest, maxFreq[i]);
+                highest = max(highest, maxFreq[i]);
+            }
+        }
+        // Everything above the little cluster: prime + big cores on tri-cluster SoCs
+        vector<int> fast;
+        for (int i = 0; i < cpus; ++i) {
+            if (highest == 0 || lowest == highest || maxFreq[i] > lowest) fast.push_back(i);
+        }
+        return fast;
+    }();
+    return cores;
+}
+
+void pinCurrentThread(const vector<int>& cpus) {
+#ifdef __linux__
+    if (cpus.empty()) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        LOGW("ThreadPool", "Could not pin thread to %zu cores", cpus.size());
+    }
+#else
+    (void)cpus;
+#endif
+}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig& config) {
+    const int threads = config.threads > 0 ? config.threads : (int)performanceCores().size();
+    if (config.performanceCoresOnly) affinity = performanceCores();
+
+    for (int i = 1; i < threads; ++i) queues.push_back(make_unique<Queue>());
+    for (int i = 1; i < threads; ++i) workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    LOGI("ThreadPool", "%d threads%s", threads, affinity.empty() ? "" : " pinned to performance cores");
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+int ThreadPool::threadIndex() {
+    return t_workerIndex;
+}
+
+void ThreadPool::runChunk(const Task& task) {
+    Job& job = *task.job;
+    const int begin = (int)((int64_t)job.tasks * task.chunk / job.chunks);
+    const int end = (int)((int64_t)job.tasks * (task.chunk + 1) / job.chunks);
+    if (begin < end) (*job.body)(begin, end);
+
+    lock_guard<mutex> lock(job.doneMutex);
+    if (--job.pending == 0) job.doneCv.notify_all();
+}
+
+bool ThreadPool::runOne(int self) {
+    const int n = (int)queues.size();
+    for (int k = 0; k < n; ++k) {
+        const int victim = self < 0 ? k : (self + k) % n;
+        Queue& queue = *queues[victim];
+        Task task;
+        {
+            lock_guard<mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            // Own queue LIFO (cache-warm), others FIFO (oldest, largest remaining work)
+            if (victim == self) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            } else {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+        }
+        {
+            lock_guard<mutex> lock(sleepMutex);
+            --queued;
+        }
+        runChunk(task);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index) {
+    t_workerIndex = index;
+    pinCurrentThread(affinity);
+    const int self = index - 1;
+    while (true) {
+        if (runOne(self)) continue;
+        unique_lock<mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(int tasks, const function<void(int, int)>& body) {
+    if (tasks <= 0) return;
+    const int chunks = min(tasks, size() * kChunksPerThread);
+    if (chunks == 1 || workers.empty() || t_workerIndex > 0) {
+        body(0, tasks);
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.tasks = tasks;
+    job.chunks = chunks;
+    job.pending = chunks;
+    for (int c = 0; c < chunks; ++c) {
+        Queue& queue = *queues[c % queues.size()];
+        lock_guard<mutex> lock(queue.mutex);
+        queue.tasks.push_back({&job, c});
+    }
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        queued += chunks;
+    }
+    wake.notify_all();
+
+    // Help until nothing is left to take, then wait for chunks still running
+    while (runOne(-1)) {}
+    unique_lock<mutex> lock(job.doneMutex);
+    job.doneCv.wait(lock, [&job] { return job.pending == 0; });
+}
+
+shared_ptr<ThreadPool> sharedThreadPool() {
+    shared_ptr<ThreadPool> pool = atomic_load(&g_pool);
+    if (pool) return pool;
+
+    lock_guard<mutex> lock(g_poolMutex);
+    if (!g_pool) atomic_store(&g_pool, make_shared<ThreadPool>(g_poolConfig));
+    return g_pool;
+}
+
+void installSharedThreadPool() {
+    static once_flag installed;
+    call_once(installed, [] {
+        sharedThreadPool();
+        cv::parallel::setParallelForBackend(make_shared<PoolParallelBackend>());
+    });
+}
+
+void configureSharedThreadPool(const ThreadPoolConfig& config) {
+    {
+        lock_guard<mutex> lock(g_poolMutex);
+        g_poolConfig = config;
+        atomic_store(&g_pool, make_shared<ThreadPool>(config));
+    }
+    installSharedThreadPool();
+}
+
+void parallelRowBands(int rows, const function<void(int, int)>& body) {
+    sharedThreadPool()->parallelFor(rows, body);
+}
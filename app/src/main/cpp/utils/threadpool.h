@@ -0,0 +1,89 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadPoolConfig {
+    int threads = 0;                   // including the calling thread; 0 = one per performance core
+    bool performanceCoresOnly = false; // pin workers to the fastest cluster (big.LITTLE)
+};
+
+// Work-stealing pool shared by every CPU stage of the library. Each worker
+// owns a deque of chunks: it pops its own from the back and steals others'
+// from the front, so uneven row bands (skin regions, dense boxes) balance
+// out instead of waiting on the slowest stripe. The calling thread runs
+// chunks too rather than sleeping on the result.
+class ThreadPool {
+public:
+    explicit ThreadPool(const ThreadPoolConfig& config = ThreadPoolConfig());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads working on a parallelFor, the caller included
+    int size() const { return (int)workers.size() + 1; }
+    // CPUs the workers are pinned to; empty when unpinned
+    const std::vector<int>& cpus() const { return affinity; }
+
+    // body(begin, end) over [0, tasks), split into a few chunks per thread.
+    // Blocks until every chunk has run. Calls made from inside a chunk run
+    // inline, like nested parallel_for_ in OpenCV.
+    void parallelFor(int tasks, const std::function<void(int, int)>& body);
+
+    // -1 outside the pool (including a caller helping its own parallelFor),
+    // 1..size()-1 on workers
+    static int threadIndex();
+
+private:
+    struct Job {
+        const std::function<void(int, int)>* body = nullptr;
+        int tasks = 0;
+        int chunks = 0;
+        int pending = 0; // guarded by doneMutex
+        std::mutex doneMutex;
+        std::condition_variable doneCv;
+    };
+    struct Task {
+        Job* job;
+        int chunk;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker
+    std::vector<std::thread> workers;
+    std::vector<int> affinity;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    int queued = 0; // guarded by sleepMutex
+    bool stopping = false;
+
+    bool runOne(int self);
+    void runChunk(const Task& task);
+    void workerLoop(int index);
+};
+
+// Library-wide pool, created on first use
+std::shared_ptr<ThreadPool> sharedThreadPool();
+// Points OpenCV's parallel_for_ backend (and with it cvtColor, GaussianBlur,
+// resize...) at the shared pool. Called once at library load (JNI_OnLoad) and
+// by the host tools' main; later calls are no-ops.
+void installSharedThreadPool();
+// Replace the shared pool; in-flight work finishes on the old one. ONNX
+// Runtime sizes its global pool once, so call this before loading a model.
+void configureSharedThreadPool(const ThreadPoolConfig& config);
+
+// Row-band split of a frame of `rows` rows on the shared pool
+void parallelRowBands(int rows, const std::function<void(int, int)>& body);
+
+// Cores of the fastest cluster from cpufreq; all cores when they are uniform
+// or the frequencies cannot be read
+const std::vector<int>& performanceCores();
+// Restrict the calling thread to `cpus` (no-op when empty or unsupported)
+void pinCurrentThread(const std::vector<int>& cpus);
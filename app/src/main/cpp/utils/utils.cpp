@@ -3,3 +3,21 @@
 cv::Mat& getMat(jlong addr) {
     return *(cv::Mat*)addr;
 }
+
+YuvPlanes getYuvPlanes(JNIEnv* env,
+                       jobject yBuffer, jint yRowStride,
+                       jobject uBuffer, jint uRowStride,
+                       jobject vBuffer, jint vRowStride,
+                       jint pixelStride, jint width, jint height) {
+    YuvPlanes planes;
+    planes.y = (const uint8_t*)env->GetDirectBufferAddress(yBuffer);
+    planes.u = (const uint8_t*)env->GetDirectBufferAddress(uBuffer);
+    planes.v = (const uint8_t*)env->GetDirectBufferAddress(vBuffer);
+    planes.yRowStride = yRowStride;
+    planes.uRowStride = uRowStride;
+    planes.vRowStride = vRowStride;
+    planes.uvPixelStride = pixelStride;
+    planes.width = width;
+    planes.height = height;
+    return planes;
+}
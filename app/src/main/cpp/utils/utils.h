@@ -1,5 +1,13 @@
 #pragma once
 #include <jni.h>
 #include <opencv2/opencv.hpp>
+#include "yuv.h"
 
 cv::Mat& getMat(jlong addr);
+
+// Wraps the direct ByteBuffers of an ImageProxy's planes without copying
+YuvPlanes getYuvPlanes(JNIEnv* env,
+                       jobject yBuffer, jint yRowStride,
+                       jobject uBuffer, jint uRowStride,
+                       jobject vBuffer, jint vRowStride,
+                       jint pixelStride, jint width, jint height);
@@ -0,0 +1,141 @@
+#include "yuv.h"
+#include "arena.h"
+#include "profiler.h"
+#include "../filters/filters.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+using namespace cv;
+
+// Scratch planes (re-interleaved chroma, filtered or downscaled planes) come
+// from the thread's FrameArena; every entry point is one arena frame.
+namespace {
+
+// Interleaves separate (or strided) chroma planes into a VU (NV21) buffer
+void interleaveChroma(const YuvPlanes& p, Mat& vu) {
+    const int cw = p.width / 2, ch = p.height / 2;
+    vu.create(ch, cw, CV_8UC2);
+    for (int i = 0; i < ch; ++i) {
+        const uint8_t* uRow = p.u + (size_t)i * p.uRowStride;
+        const uint8_t* vRow = p.v + (size_t)i * p.vRowStride;
+        uint8_t* dst = vu.ptr<uint8_t>(i);
+        int j = 0;
+#if CV_SIMD128
+        if (p.uvPixelStride == 1) {
+            for (; j <= cw - 16; j += 16) {
+                v_store_interleave(dst + 2 * j, v_load(vRow + j), v_load(uRow + j));
+            }
+        } else if (p.uvPixelStride == 2) {
+            // Strict bound: the last chroma row may end right after its final sample
+            for (; j + 16 < cw; j += 16) {
+                v_uint8x16 vEven, vOdd, uEven, uOdd;
+                v_load_deinterleave(vRow + 2 * j, vEven, vOdd);
+                v_load_deinterleave(uRow + 2 * j, uEven, uOdd);
+                v_store_interleave(dst + 2 * j, vEven, uEven);
+            }
+        }
+#endif
+        for (; j < cw; ++j) {
+            dst[2 * j] = vRow[j * p.uvPixelStride];
+            dst[2 * j + 1] = uRow[j * p.uvPixelStride];
+        }
+    }
+}
+
+// Wraps Y and an interleaved 2-channel chroma view around the planes.
+// Returns true for UV (NV12) order, false for VU (NV21). A re-interleaved
+// chroma copy lives until the caller's FrameScope ends.
+bool yuvViews(const YuvPlanes& p, Mat& yMat, Mat& chroma) {
+    yMat = Mat(p.height, p.width, CV_8UC1, (void*)p.y, p.yRowStride);
+
+    if (p.uvPixelStride == 2 && p.uRowStride == p.vRowStride) {
+        if (p.u == p.v + 1) {
+            chroma = Mat(p.height / 2, p.width / 2, CV_8UC2, (void*)p.v, p.vRowStride);
+            return false;
+        }
+        if (p.v == p.u + 1) {
+            chroma = Mat(p.height / 2, p.width / 2, CV_8UC2, (void*)p.u, p.uRowStride);
+            return true;
+        }
+    }
+
+    Mat& vu = FrameArena::local().acquire(p.height / 2, p.width / 2, CV_8UC2);
+    interleaveChroma(p, vu);
+    chroma = vu;
+    return false;
+}
+
+} // namespace
+
+void yuvToRgba(const YuvPlanes& planes, Mat& rgba) {
+    PROFILE_STAGE(Stage::YuvConvert);
+    FrameScope frame;
+    Mat yMat, chroma;
+    bool nv12 = yuvViews(planes, yMat, chroma);
+    cvtColorTwoPlane(yMat, chroma, rgba, nv12 ? COLOR_YUV2RGBA_NV12 : COLOR_YUV2RGBA_NV21);
+}
+
+bool lumaFilterFromName(const std::string& name, LumaFilter& filter) {
+    static const std::pair<const char*, LumaFilter> kNames[] = {
+        {"Gray", LumaFilter::Gray},
+        {"HistEq", LumaFilter::HistEq},
+        {"Binary", LumaFilter::Binary},
+        {"Dehaze", LumaFilter::Dehaze},
+    };
+    for (const auto& entry : kNames) {
+        if (name == entry.first) {
+            filter = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void yuvToRgbaFiltered(const YuvPlanes& planes, LumaFilter filter, Mat& rgba) {
+    FrameScope frame;
+    const Mat y(planes.height, planes.width, CV_8UC1, (void*)planes.y, planes.yRowStride);
+    Mat& luma = FrameArena::local().acquire(y.size(), CV_8UC1);
+    {
+        PROFILE_STAGE(Stage::Filters);
+        switch (filter) {
+            case LumaFilter::Gray: grayFromLuma(y, luma); break;
+            case LumaFilter::Binary: binaryFromLuma(y, luma); break;
+            case LumaFilter::HistEq: equalizeLuma(y, luma); break;
+            case LumaFilter::Dehaze: dehazeLuma(y, luma); break;
+        }
+    }
+
+    PROFILE_STAGE(Stage::YuvConvert);
+    if (filter == LumaFilter::Gray || filter == LumaFilter::Binary) {
+        cvtColor(luma, rgba, COLOR_GRAY2RGBA);
+        return;
+    }
+    // Chroma is untouched, as in the YCrCb/Lab versions of these filters
+    Mat yMat, chroma;
+    bool nv12 = yuvViews(planes, yMat, chroma);
+    cvtColorTwoPlane(luma, chroma, rgba, nv12 ? COLOR_YUV2RGBA_NV12 : COLOR_YUV2RGBA_NV21);
+}
+
+LetterboxTransform yuvToLetterbox(const YuvPlanes& planes, Size netSize, Mat& dst) {
+    PROFILE_STAGE(Stage::YuvConvert);
+    const Size srcSize(planes.width, planes.height);
+    LetterboxTransform t = computeLetterbox(srcSize, netSize);
+    Rect inner = letterboxRect(srcSize, netSize, t);
+    // 4:2:0 conversion needs even sizes; dropping at most one pixel is well below box precision
+    inner.width &= ~1;
+    inner.height &= ~1;
+
+    FrameScope frame;
+    Mat yMat, chroma;
+    bool nv12 = yuvViews(planes, yMat, chroma);
+    Mat& ySmall = FrameArena::local().acquire(inner.size(), CV_8UC1);
+    Mat& chromaSmall = FrameArena::local().acquire(inner.height / 2, inner.width / 2, CV_8UC2);
+    resize(yMat, ySmall, ySmall.size(), 0, 0, INTER_LINEAR);
+    resize(chroma, chromaSmall, chromaSmall.size(), 0, 0, INTER_LINEAR);
+
+    dst.create(netSize, CV_8UC3);
+    dst.setTo(Scalar::all(LetterboxPreprocessor::kPadValue));
+    Mat roi = dst(inner);
+    cvtColorTwoPlane(ySmall, chromaSmall, roi, nv12 ? COLOR_YUV2RGB_NV12 : COLOR_YUV2RGB_NV21);
+    return t;
+}
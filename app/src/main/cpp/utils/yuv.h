@@ -0,0 +1,44 @@
+#pragma once
+#include "../ai/engine/Letterbox.h"
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+
+// View over an Android YUV_420_888 image: three planes with arbitrary row
+// strides and a shared chroma pixel stride. Nothing is copied.
+struct YuvPlanes {
+    const uint8_t* y = nullptr;
+    const uint8_t* u = nullptr;
+    const uint8_t* v = nullptr;
+    int yRowStride = 0;
+    int uRowStride = 0;
+    int vRowStride = 0;
+    int uvPixelStride = 1;
+    int width = 0;
+    int height = 0;
+};
+
+// YUV -> RGBA. When the chroma planes alias an interleaved VU (NV21) or UV
+// (NV12) buffer, which is the common pixelStride == 2 case, they are used in
+// place; otherwise chroma is re-interleaved with SIMD. Y is never copied.
+void yuvToRgba(const YuvPlanes& planes, cv::Mat& rgba);
+
+// Filters that only need luminance, applied to the Y plane during ingestion
+enum class LumaFilter {
+    Gray,
+    HistEq,
+    Binary,
+    Dehaze,
+};
+
+// Maps the UI filter names ("Gray", "HistEq", ...); false for other filters
+bool lumaFilterFromName(const std::string& name, LumaFilter& filter);
+
+// YUV -> RGBA with `filter` applied on the way: the Y plane is filtered and
+// the frame is written to RGBA once, instead of converting the RGBA frame
+// back to BGR/YCrCb/Lab/gray and out again. Gray and Binary skip chroma.
+void yuvToRgbaFiltered(const YuvPlanes& planes, LumaFilter filter, cv::Mat& rgba);
+
+// YUV -> letterboxed 8-bit RGB image of netSize for the detector, converting
+// only the downscaled planes instead of a full-resolution RGBA frame.
+LetterboxTransform yuvToLetterbox(const YuvPlanes& planes, cv::Size netSize, cv::Mat& dst);
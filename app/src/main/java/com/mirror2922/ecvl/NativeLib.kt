@@ -3,13 +3,20 @@ package com.mirror2922.ecvl
 class NativeLib {
 
     external fun stringFromJNI(): String
+    // Shared worker pool for filters, OpenCV and ONNX Runtime. threads = 0: one per performance core.
+    // Call before the first model load; ORT sizes its pool once.
+    external fun setThreadPool(threads: Int, performanceCoresOnly: Boolean)
 
     external fun applyBeautyFilter(matAddr: Long)
+    // strength: 0 = off, 1 = full skin smoothing
+    external fun applyBeautyFilterStrength(matAddr: Long, strength: Float)
     
     // New Filters
     external fun applyDehaze(matAddr: Long)
     external fun applyUnderwater(matAddr: Long)
     external fun applyStage(matAddr: Long)
+    // radius/falloff relative to the shorter image side (defaults 0.5 / 0.5)
+    external fun applyStageVignette(matAddr: Long, radius: Float, falloff: Float)
 
     // Legacy/Utils
     external fun applyGray(matAddr: Long)
@@ -19,12 +26,54 @@ class NativeLib {
     external fun applyMorphClose(matAddr: Long)
     external fun applyBlur(matAddr: Long)
     external fun recognizeColorBlock(matAddr: Long): String
+
+    // Filter chains: set the ordered filter names once, then apply the whole chain per frame
+    external fun setFilterChain(filterNames: Array<String>)
+    external fun setFilterChainBeautyStrength(strength: Float)
+    external fun applyFilterChain(matAddr: Long)
+    // Video mode for HistEq/Dehaze: tone LUTs recomputed every updateInterval frames from subsampled
+    // histograms and blended in with weight smoothing (0-1), instead of per-frame equalization
+    external fun setFilterVideoMode(enabled: Boolean, updateInterval: Int, smoothing: Float)
     
     // AI
     external fun initYolo(modelPath: String): Boolean
+    // Class names of the loaded model, indexed by class id (model metadata, <model>.names sidecar, or COCO)
+    external fun getClassNames(): Array<String>
     external fun setInferenceEngine(engine: String)
     external fun setHardwareBackend(backend: String)
+    // Startup: ORT optimized-graph cache location, background warm-up after load,
+    // and load-to-first-detection latency (-1 until the first detection)
+    external fun setModelCacheDir(dir: String)
+    external fun setEngineWarmup(enabled: Boolean)
+    external fun getTimeToFirstDetectionMs(): Float
+    // ONNX Runtime session tuning; intraOpThreads = 0 runs on the shared pool, > 0 gives the session
+    // its own pool of that size. Rebuilds the session.
+    external fun setOrtSessionConfig(intraOpThreads: Int, interOpThreads: Int, allowSpinning: Boolean, parallelExecution: Boolean)
     external fun yoloInference(matAddr: Long, confidence: Float, iou: Float, activeClassIds: IntArray): String
+    // Async mode: yoloInference returns the latest completed results; getResultFrameId tells which frame they came from
+    external fun setAsyncInference(enabled: Boolean)
+    external fun getResultFrameId(): Long
+    // Detect every N frames, tracking boxes in between; results carry a stable "track" id
+    external fun setDetectionInterval(frames: Int)
+    // Motion gate: static scenes reuse the last results. blockThreshold is the mean luma change (0-255)
+    // per block, runFraction the changed area that triggers a full run, maxStaleFrames forces a refresh.
+    external fun setMotionGate(enabled: Boolean, blockThreshold: Float, runFraction: Float, maxStaleFrames: Int, regionDetection: Boolean)
+    external fun getMotionSkipRatio(): Float
+    // Off: yoloInference returns results without drawing, for overlays rendered in the UI
+    external fun setDrawOverlay(enabled: Boolean)
+    // NMS: per-class unless classAgnostic; top-K candidates before suppression, cap on kept boxes
+    external fun setNmsConfig(classAgnostic: Boolean, maxCandidates: Int, maxDetections: Int)
+    // High-res frames: overlapping tiles (+ optional whole-frame view) in one batched inference.
+    // Synchronous yoloInference only.
+    external fun setTiledDetection(enabled: Boolean, overlap: Float, maxTiles: Int, globalView: Boolean)
+
+    // Packed results: 7 floats per detection (x, y, w, h, conf, classId, trackId).
+    // Buffers are direct and in ByteOrder.nativeOrder(); return value is the record count
+    // (clamped to the buffer capacity), -1 if the buffer is unusable.
+    // These use the class filter from setActiveClasses (null or empty = all classes).
+    external fun setActiveClasses(activeClassIds: IntArray?)
+    external fun yoloInferencePacked(matAddr: Long, confidence: Float, iou: Float, out: java.nio.ByteBuffer): Int
+    external fun yoloInferenceArray(matAddr: Long, confidence: Float, iou: Float, out: FloatArray): Int
 
     // Efficient conversion
     external fun yuvToRgba(
@@ -35,6 +84,39 @@ class NativeLib {
         width: Int, height: Int,
         outMatAddr: Long
     )
+    // Conversion with a luma-only filter (Gray, HistEq, Binary, Dehaze) applied on the Y plane, writing
+    // RGBA once. Returns false and converts unfiltered for any other filter name.
+    external fun yuvToRgbaFiltered(
+        yPlane: java.nio.ByteBuffer, yRowStride: Int,
+        uPlane: java.nio.ByteBuffer, uRowStride: Int,
+        vPlane: java.nio.ByteBuffer, vRowStride: Int,
+        pixelStride: Int,
+        width: Int, height: Int,
+        filter: String, outMatAddr: Long
+    ): Boolean
+
+    // Inference-only path: YUV planes converted straight into the detector input, no RGBA frame.
+    // Boxes are in the unrotated sensor frame; nothing is drawn.
+    external fun yuvInference(
+        yPlane: java.nio.ByteBuffer, yRowStride: Int,
+        uPlane: java.nio.ByteBuffer, uRowStride: Int,
+        vPlane: java.nio.ByteBuffer, vRowStride: Int,
+        pixelStride: Int,
+        width: Int, height: Int,
+        confidence: Float, iou: Float, activeClassIds: IntArray
+    ): String
+    external fun yuvInferencePacked(
+        yPlane: java.nio.ByteBuffer, yRowStride: Int,
+        uPlane: java.nio.ByteBuffer, uRowStride: Int,
+        vPlane: java.nio.ByteBuffer, vRowStride: Int,
+        pixelStride: Int,
+        width: Int, height: Int,
+        confidence: Float, iou: Float, out: java.nio.ByteBuffer
+    ): Int
+
+    // Per-stage latency percentiles (ms) over recent frames, as JSON keyed by stage name
+    external fun getStageTimings(): String
+    external fun resetStageTimings()
 
     companion object {
         init {
@@ -65,6 +65,8 @@ fun CameraView(viewModel: BeautyViewModel) {
     }
 
     DisposableEffect(lifecycleOwner, viewModel.lensFacing, targetCaptureSize) {
+        // Live preview: HistEq/Dehaze reuse smoothed tone LUTs across frames (new camera = fresh LUTs)
+        nativeLib.setFilterVideoMode(true, 4, 0.25f)
         val cameraProviderFuture = ProcessCameraProvider.getInstance(context)
         val listener = Runnable {
             val cameraProvider = cameraProviderFuture.get()
@@ -85,12 +87,14 @@ fun CameraView(viewModel: BeautyViewModel) {
             imageAnalysis.setAnalyzer(executor) { imageProxy ->
                 try {
                     val startTime = System.currentTimeMillis()
-                    nativeLib.yuvToRgba(
+                    // Luma-only filters run on the Y plane during conversion
+                    val ingestFilter = if (viewModel.currentMode == AppMode.AI) "Normal" else viewModel.selectedFilter
+                    val filteredOnIngest = nativeLib.yuvToRgbaFiltered(
                         imageProxy.planes[0].buffer, imageProxy.planes[0].rowStride,
                         imageProxy.planes[1].buffer, imageProxy.planes[1].rowStride,
                         imageProxy.planes[2].buffer, imageProxy.planes[2].rowStride,
                         imageProxy.planes[1].pixelStride,
-                        imageProxy.width, imageProxy.height, rgbaMat.nativeObjAddr
+                        imageProxy.width, imageProxy.height, ingestFilter, rgbaMat.nativeObjAddr
                     )
                     
                     val rotation = imageProxy.imageInfo.rotationDegrees
@@ -123,7 +127,7 @@ fun CameraView(viewModel: BeautyViewModel) {
                         } else { previewMat.copyTo(aiMat) }
                         
                         viewModel.actualBackendSize = "${aiMat.cols()}x${aiMat.rows()}"
-                        val activeIds = viewModel.selectedYoloClasses.map { viewModel.allCOCOClasses.indexOf(it) }.filter { it >= 0 }.toIntArray()
+                        val activeIds = viewModel.selectedYoloClassIds()
                         val jsonResult = nativeLib.yoloInference(aiMat.nativeObjAddr, viewModel.yoloConfidence, viewModel.yoloIoU, activeIds)
                         
                         val results = mutableListOf<YoloResultData>()
@@ -139,7 +143,7 @@ fun CameraView(viewModel: BeautyViewModel) {
                             viewModel.detectedYoloObjects.addAll(results)
                         }
                     } else {
-                        if (viewModel.selectedFilter != "Normal") {
+                        if (viewModel.selectedFilter != "Normal" && !filteredOnIngest) {
                             when (viewModel.selectedFilter) {
                                 "Beauty" -> nativeLib.applyBeautyFilter(previewMat.nativeObjAddr)
                                 "Dehaze" -> nativeLib.applyDehaze(previewMat.nativeObjAddr)
@@ -179,7 +183,11 @@ fun CameraView(viewModel: BeautyViewModel) {
             try { cameraProvider.bindToLifecycle(lifecycleOwner, selector, imageAnalysis) } catch (e: Exception) { e.printStackTrace() }
         }
         cameraProviderFuture.addListener(listener, ContextCompat.getMainExecutor(context))
-        onDispose { cameraProviderFuture.get().unbindAll() }
+        onDispose {
+            cameraProviderFuture.get().unbindAll()
+            // Still images go back to exact per-frame equalization
+            nativeLib.setFilterVideoMode(false, 0, 0f)
+        }
     }
 
     DisposableEffect(Unit) {
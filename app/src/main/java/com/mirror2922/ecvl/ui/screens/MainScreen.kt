@@ -78,8 +78,15 @@ fun MainScreen(navController: NavController, viewModel: BeautyViewModel) {
         viewModel.isLoading = true
         withContext(Dispatchers.IO) {
             val modelFile = File(context.filesDir, "${viewModel.currentModelId}.onnx")
-            if (modelFile.exists()) NativeLib().initYolo(modelFile.absolutePath)
-            withContext(Dispatchers.Main) { viewModel.isLoading = false }
+            var classNames = emptyArray<String>()
+            if (modelFile.exists()) {
+                NativeLib().setModelCacheDir(context.cacheDir.absolutePath)
+                if (NativeLib().initYolo(modelFile.absolutePath)) classNames = NativeLib().getClassNames()
+            }
+            withContext(Dispatchers.Main) {
+                viewModel.updateYoloClasses(classNames)
+                viewModel.isLoading = false
+            }
         }
     }
 
@@ -59,7 +59,7 @@ fun YoloObjectListScreen(navController: NavController, viewModel: BeautyViewMode
 
             HorizontalDivider(modifier = Modifier.padding(vertical = 16.dp))
 
-            val filteredClasses = viewModel.allCOCOClasses.filter { 
+            val filteredClasses = viewModel.yoloClassNames.filter { 
                 it.contains(searchQuery, ignoreCase = true) && !viewModel.selectedYoloClasses.contains(it) 
             }
 
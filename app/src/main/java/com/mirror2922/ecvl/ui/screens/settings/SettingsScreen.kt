@@ -153,6 +153,7 @@ private fun EngineSelector(viewModel: BeautyViewModel) {
                 onClick = { 
                     viewModel.inferenceEngine = engine
                     NativeLib().setInferenceEngine(engine)
+                    viewModel.updateYoloClasses(NativeLib().getClassNames())
                     viewModel.saveSettings()
                 },
                 label = { Text(engine) },
@@ -90,7 +90,8 @@ class BeautyViewModel(application: Application) : AndroidViewModel(application)
     var yoloConfidence by mutableStateOf(prefs.getFloat("yolo_conf", 0.5f))
     var yoloIoU by mutableStateOf(prefs.getFloat("yolo_iou", 0.45f))
     
-    val allCOCOClasses = listOf(
+    // Shown until a model is loaded; afterwards the list comes from the model (NativeLib.getClassNames)
+    private val cocoClasses = listOf(
         "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat", "traffic light",
         "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat", "dog", "horse", "sheep", "cow",
         "elephant", "bear", "zebra", "giraffe", "backpack", "umbrella", "handbag", "tie", "suitcase", "frisbee",
@@ -101,7 +102,9 @@ class BeautyViewModel(application: Application) : AndroidViewModel(application)
         "microwave", "oven", "toaster", "sink", "refrigerator", "book", "clock", "vase", "scissors", "teddy bear",
         "hair drier", "toothbrush"
     )
-    val selectedYoloClasses = mutableStateListOf<String>().apply { addAll(allCOCOClasses) }
+    // Class names of the loaded model, indexed by class id
+    val yoloClassNames = mutableStateListOf<String>().apply { addAll(cocoClasses) }
+    val selectedYoloClasses = mutableStateListOf<String>().apply { addAll(cocoClasses) }
 
     val availableModels = mutableStateListOf(
         ModelInfo("yolov8n", "YOLOv8 Nano", "https://huggingface.co/unity/inference-engine-yolo/resolve/main/models/yolov8n.onnx", "Classic small YOLO model"),
@@ -150,6 +153,21 @@ class BeautyViewModel(application: Application) : AndroidViewModel(application)
         }
     }
 
+    // Called after a model load or engine switch. Keeps the selections the new model also has;
+    // if none survive, every class is selected.
+    fun updateYoloClasses(names: Array<String>) {
+        if (names.isEmpty() || names.toList() == yoloClassNames.toList()) return
+        val kept = selectedYoloClasses.filter { it in names }
+        yoloClassNames.clear()
+        yoloClassNames.addAll(names)
+        selectedYoloClasses.clear()
+        selectedYoloClasses.addAll(if (kept.isEmpty()) names.toList() else kept)
+    }
+
+    // Class ids for the native side: positions in the loaded model's class list
+    fun selectedYoloClassIds(): IntArray =
+        selectedYoloClasses.map { yoloClassNames.indexOf(it) }.filter { it >= 0 }.toIntArray()
+
     fun toggleYoloClass(className: String) {
         if (selectedYoloClasses.contains(className)) selectedYoloClasses.remove(className)
         else selectedYoloClasses.add(className)